@@ -0,0 +1,18 @@
+# Command line batch solver: cuttingbatch <job-directory> [-o <output-directory>] [-j <threads>] [-m greedy|bfd|cg|lns] [-s <seed>] [-t <seconds>] [-u <unit>] [-r <offcut-file>] [--stats <file>] [--trace <file>] [-f text|csv|json|cutlist|binary] [-b]
+
+TEMPLATE = app
+TARGET = cuttingbatch
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../solver/solver.pri)
+
+unix: LIBS += -pthread
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
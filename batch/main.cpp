@@ -0,0 +1,232 @@
+// Command line front end: solves every job file in a directory, in parallel,
+// and writes one result file per job.
+
+#include "chunked_solver.h"
+#include "cutting_job.h"
+#include "cutting_solver.h"
+#include "remnant_store.h"
+#include "result_writer.h"
+#include "solve_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char *resultSuffix = ".result.txt";
+
+static void printUsage(const char *program) {
+    std::cerr << "Usage: " << program << " <job-directory> [-o <output-directory>] [-j <threads>] [-m greedy|bfd|cg|lns] [-s <seed>] [-t <seconds>] [-u <unit>] [-r <offcut-file> [--min-offcut <length>]] [--stats <file>] [--trace <file>] [-c <checkpoint-directory> [--checkpoint-every <seconds>]] [--chunk <pieces>] [-f text|csv|json|cutlist|binary] [-b]\n"
+              << "Solves every *.txt and *.cutjob job in <job-directory> and writes <job>" << resultSuffix << " files,\n"
+              << "or <job>.result.csv, .json, .cutlist (one line per bar, for the saw) or .cutres files with -f;\n"
+              << "-b is short for -f binary.\n"
+              << "Default output directory is <job-directory>/results, default threads is one per core.\n"
+              << "-t limits the time spent improving each job; the best plan found by then is written.\n"
+              << "-s seeds the local search (lns); the same seed and thread count give the same plans.\n"
+              << "-u is the length step the solver works in, by default the coarsest of 0.1, 0.01 and 0.001 that\n"
+              << "every length of the job lies on; pieces off it are rounded up and bars down.\n"
+              << "-r cuts from the offcuts in <offcut-file> before new stock and keeps every remainder of at least\n"
+              << "--min-offcut (default " << defaultMinRemnantLength << ") in it; jobs then run one after another, in name order.\n"
+              << "--stats writes the phase times, work counters and peak memory of the process as JSON, --trace the\n"
+              << "phases as a Chrome trace (chrome://tracing or Perfetto).\n"
+              << "-c saves the state of each solve to <checkpoint-directory>/<job>" << checkpointExtension << " every\n"
+              << "--checkpoint-every seconds (default 60) and at the end; a later run with the same -c and settings\n"
+              << "carries on from there. Delete the file to solve the job from scratch.\n"
+              << "--chunk reads and solves each job <pieces> pieces at a time, several chunks at once, for orders too\n"
+              << "large to solve whole; -c does not apply then. Chunks under 100 pieces cut less when stock is\n"
+              << "short.\n";
+}
+
+static bool endsWith(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    fs::path jobDirectory;
+    fs::path outputDirectory;
+    unsigned threadCount = std::thread::hardware_concurrency();
+    SolverOptions options;
+    ResultFormat resultFormat = ResultFormat::Report;
+    std::string remnantFile;
+    double minRemnantLength = defaultMinRemnantLength;
+    std::string statsFile;
+    std::string traceFile;
+    fs::path checkpointDirectory;
+    ChunkOptions chunking;
+    bool chunked = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputDirectory = argv[++i];
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            threadCount = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if ((arg == "-m" || arg == "--mode") && i + 1 < argc) {
+            if (!parseSolverMode(argv[++i], options.mode)) {
+                std::cerr << "Unknown solver mode: " << argv[i] << "\n";
+                return 2;
+            }
+        } else if ((arg == "-s" || arg == "--seed") && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if ((arg == "-t" || arg == "--time-limit") && i + 1 < argc) {
+            options.timeLimit = std::atof(argv[++i]);
+        } else if ((arg == "-u" || arg == "--unit") && i + 1 < argc) {
+            options.lengthUnit = std::atof(argv[++i]);
+        } else if ((arg == "-r" || arg == "--offcuts") && i + 1 < argc) {
+            remnantFile = argv[++i];
+        } else if (arg == "--min-offcut" && i + 1 < argc) {
+            minRemnantLength = std::atof(argv[++i]);
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if ((arg == "-c" || arg == "--checkpoint") && i + 1 < argc) {
+            checkpointDirectory = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            options.checkpointInterval = std::atof(argv[++i]);
+        } else if (arg == "--chunk" && i + 1 < argc) {
+            chunking.chunkPieces = std::atoll(argv[++i]);
+            chunked = chunking.chunkPieces > 0;
+        } else if ((arg == "-f" || arg == "--format") && i + 1 < argc) {
+            if (!parseResultFormat(argv[++i], resultFormat)) {
+                std::cerr << "Unknown result format: " << argv[i] << "\n";
+                return 2;
+            }
+        } else if (arg == "-b" || arg == "--binary") {
+            resultFormat = ResultFormat::Binary;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (jobDirectory.empty() && !arg.empty() && arg[0] != '-') {
+            jobDirectory = arg;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (jobDirectory.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (outputDirectory.empty())
+        outputDirectory = jobDirectory / "results";
+    if (threadCount == 0)
+        threadCount = 1;
+
+    std::error_code error;
+    if (!fs::is_directory(jobDirectory, error)) {
+        std::cerr << "Not a directory: " << jobDirectory.string() << "\n";
+        return 2;
+    }
+    fs::create_directories(outputDirectory, error);
+    if (error) {
+        std::cerr << "Cannot create output directory " << outputDirectory.string() << ": " << error.message() << "\n";
+        return 2;
+    }
+    if (!checkpointDirectory.empty()) {
+        fs::create_directories(checkpointDirectory, error);
+        if (error) {
+            std::cerr << "Cannot create checkpoint directory " << checkpointDirectory.string() << ": " << error.message() << "\n";
+            return 2;
+        }
+    }
+
+    // Collect the jobs up front, sorted so runs are reproducible
+    std::vector<fs::path> jobFiles;
+    for (const auto &entry : fs::directory_iterator(jobDirectory)) {
+        if (!entry.is_regular_file())
+            continue;
+        std::string name = entry.path().filename().string();
+        if ((entry.path().extension() == ".txt" && !endsWith(name, resultSuffix)) || entry.path().extension() == ".cutjob")
+            jobFiles.push_back(entry.path());
+    }
+    std::sort(jobFiles.begin(), jobFiles.end());
+
+    // Jobs run in parallel first; threads left over go to the profile groups inside each job.
+    // Every job takes the offcuts the ones before it left, so with a store they run in turn.
+    unsigned jobThreads = std::min<unsigned>(threadCount, std::max<std::size_t>(jobFiles.size(), 1));
+    if (!remnantFile.empty())
+        jobThreads = 1;
+    options.threads = threadCount / jobThreads;
+
+    SolveStats stats;
+    if (!statsFile.empty() || !traceFile.empty())
+        options.stats = &stats;
+
+    std::atomic<std::size_t> nextJob{0};
+    std::atomic<int> failedJobs{0};
+    std::mutex logMutex;
+
+    auto worker = [&]() {
+        for (std::size_t index = nextJob++; index < jobFiles.size(); index = nextJob++) {
+            const fs::path &jobFile = jobFiles[index];
+            fs::path resultFile = outputDirectory / (jobFile.stem().string() + ".result" + resultFormatExtension(resultFormat));
+
+            // A chunked job is read as it is solved
+            CuttingJob job;
+            JobReader reader;
+            std::string errorMessage;
+            const std::string jobName = jobFile.filename().string();
+            PhaseTimer parseTimer(options.stats, "parse", jobName.c_str());
+            bool ok = chunked ? reader.open(jobFile.string(), &errorMessage) : loadJobFile(jobFile.string(), job, &errorMessage);
+            parseTimer.stop();
+
+            RemnantStore remnants;
+            SolveCache cache;
+            SolverOptions jobOptions = options;
+            if (ok && !chunked && !checkpointDirectory.empty()) {
+                // A checkpoint that cannot be read is no reason to fail the job
+                jobOptions.checkpointFile = (checkpointDirectory / (jobFile.stem().string() + checkpointExtension)).string();
+                jobOptions.cache = &cache;
+                std::string checkpointError;
+                std::error_code missing;
+                if (fs::exists(jobOptions.checkpointFile, missing) && !cache.load(jobOptions.checkpointFile, &checkpointError)) {
+                    std::lock_guard<std::mutex> lock(logMutex);
+                    std::cerr << checkpointError << ", solving " << jobName << " from scratch\n";
+                }
+            }
+            if (ok && !remnantFile.empty()) {
+                jobOptions.remnants = &remnants;
+                ok = remnants.open(remnantFile, &errorMessage);
+            }
+            if (ok) {
+                CuttingResult result = chunked ? solveJobInChunks(reader, jobOptions, chunking) : solveCuttingJob(job, jobOptions);
+                remnants.close();
+                PhaseTimer writeTimer(options.stats, "write", jobName.c_str());
+                ok = saveResultFile(resultFile.string(), result, resultFormat, &errorMessage)
+                     && (remnantFile.empty() || RemnantStore::update(remnantFile, result, minRemnantLength, &errorMessage));
+            }
+
+            if (!ok) {
+                failedJobs++;
+                std::lock_guard<std::mutex> lock(logMutex);
+                std::cerr << errorMessage << "\n";
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < jobThreads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &thread : workers)
+        thread.join();
+
+    std::string errorMessage;
+    bool statsSaved = (statsFile.empty() || stats.saveJson(statsFile, &errorMessage))
+                      && (traceFile.empty() || stats.saveChromeTrace(traceFile, &errorMessage));
+    if (!statsSaved)
+        std::cerr << errorMessage << "\n";
+
+    std::cout << "Solved " << (jobFiles.size() - failedJobs) << " of " << jobFiles.size()
+              << " jobs using " << threadCount << " threads (" << solverModeName(options.mode) << ")\n";
+    return failedJobs > 0 || !statsSaved ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+# Solver benchmark: cuttingbench [--suite quick|full] [--seeds <n>] [--modes greedy,bfd,cg,lns] [--csv|--json] [<instance-file>...]
+
+TEMPLATE = app
+TARGET = cuttingbench
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(../solver/solver.pri)
+
+unix: LIBS += -pthread
+
+SOURCES += \
+    instances.cpp \
+    main.cpp
+
+HEADERS += \
+    instances.h
@@ -0,0 +1,145 @@
+#include "instances.h"
+
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace {
+
+// splitmix64; the standard distributions differ between library
+// implementations, so instances are drawn with this instead
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    // Uniform in [low, high]; the modulo bias is far below anything that matters here
+    int uniform(int low, int high) {
+        return low + static_cast<int>(next() % static_cast<std::uint64_t>(high - low + 1));
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// One stock row with enough bars for any plan, and the pieces merged per length
+void makeJob(const std::map<int, int> &pieces, int barLength, CuttingJob &job) {
+    int pieceCount = 0;
+    for (const auto &lengthAndCount : pieces)
+        pieceCount += lengthAndCount.second;
+
+    job.stock.push_back({"BENCH", pieceCount, static_cast<double>(barLength)});
+    for (auto it = pieces.rbegin(); it != pieces.rend(); ++it)
+        job.cuts.push_back({"BENCH", static_cast<double>(it->first), it->second});
+}
+
+} // namespace
+
+const std::vector<std::string> &generatorFamilies() {
+    static const std::vector<std::string> families = {"uniform", "triplet", "falkenauer", "small-cuts"};
+    return families;
+}
+
+bool generateInstance(const std::string &family, int size, std::uint64_t seed, BenchInstance &instance) {
+    Random random(seed * 1000003 + static_cast<std::uint64_t>(size));
+    std::map<int, int> pieces;
+    int barLength = 0;
+
+    if (family == "uniform") {
+        barLength = 10000;
+        for (int i = 0; i < size; ++i)
+            pieces[random.uniform(1000, 5000)] += random.uniform(1, 50);
+    } else if (family == "triplet") {
+        // Falkenauer's construction: the third piece makes up the rest of the bar
+        barLength = 1000;
+        for (int i = 0; i < size / 3; ++i) {
+            int first = random.uniform(380, 490);
+            int second = random.uniform(250, (barLength - first) / 2);
+            pieces[first]++;
+            pieces[second]++;
+            pieces[barLength - first - second]++;
+        }
+    } else if (family == "falkenauer") {
+        barLength = 150;
+        for (int i = 0; i < size; ++i)
+            pieces[random.uniform(20, 100)]++;
+    } else if (family == "small-cuts") {
+        barLength = 12000;
+        for (int i = 0; i < size; ++i)
+            pieces[random.uniform(50, 600)] += random.uniform(50, 500);
+    } else {
+        return false;
+    }
+
+    instance.name = family + "-" + std::to_string(size) + "-s" + std::to_string(seed);
+    instance.family = family;
+    instance.seed = seed;
+    instance.job = CuttingJob();
+    makeJob(pieces, barLength, instance.job);
+    return true;
+}
+
+bool loadInstanceFile(const std::string &fileName, BenchInstance &instance, std::string *errorMessage) {
+    instance.name = fileName;
+    instance.family = "file";
+    instance.seed = 0;
+    instance.job = CuttingJob();
+
+    std::ifstream in(fileName);
+    if (!in) {
+        if (errorMessage)
+            *errorMessage = "Cannot open file: " + fileName;
+        return false;
+    }
+
+    // Our own formats start with a header or magic bytes, classic files with a number
+    char first = 0;
+    while (in.get(first) && std::isspace(static_cast<unsigned char>(first))) {
+    }
+    if (!std::isdigit(static_cast<unsigned char>(first)))
+        return loadJobFile(fileName, instance.job, errorMessage);
+    in.unget();
+
+    long long count = 0;
+    double capacity = 0;
+    in >> count >> capacity;
+    std::string line;
+    std::getline(in, line);
+
+    std::map<double, int> pieces;
+    bool pairs = false;
+    for (long long row = 0; row < count && std::getline(in, line);) {
+        std::istringstream fields(line);
+        double length;
+        int demand = 1;
+        if (!(fields >> length))
+            continue;  // Blank line
+        if (fields >> demand) {
+            pairs = true;
+        } else if (pairs) {
+            demand = 1;
+        }
+        pieces[length] += demand;
+        ++row;
+    }
+    if (count <= 0 || capacity <= 0 || pieces.empty()) {
+        if (errorMessage)
+            *errorMessage = fileName + ": not a bin packing or cutting stock instance";
+        return false;
+    }
+
+    int pieceCount = 0;
+    for (const auto &lengthAndCount : pieces)
+        pieceCount += lengthAndCount.second;
+    instance.job.stock.push_back({"BENCH", pieceCount, capacity});
+    for (auto it = pieces.rbegin(); it != pieces.rend(); ++it)
+        instance.job.cuts.push_back({"BENCH", it->first, it->second});
+    return true;
+}
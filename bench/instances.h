@@ -0,0 +1,34 @@
+#ifndef INSTANCES_H
+#define INSTANCES_H
+
+// Benchmark instances: seeded generators that give the same orders on every
+// platform, and readers for the classic bin packing / cutting stock files.
+
+#include "cutting_job.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct BenchInstance {
+    std::string name;     // Unique within a run, e.g. "triplet-120-s1"
+    std::string family;   // Generator name, or "file"
+    std::uint64_t seed = 0;
+    CuttingJob job;
+};
+
+// Generator families:
+//   uniform      bars of 10000, 20 to 60 distinct lengths from 10% to 50% of a bar
+//   triplet      Falkenauer T: bars of 1000, pieces in triplets that fill a bar exactly
+//   falkenauer   Falkenauer U: bars of 150, pieces uniform in [20, 100]
+//   small-cuts   bars of 12000, many small cuts from 50 to 600 in large quantities
+// `size` is the number of pieces, or of distinct lengths for uniform and small-cuts.
+const std::vector<std::string> &generatorFamilies();
+bool generateInstance(const std::string &family, int size, std::uint64_t seed, BenchInstance &instance);
+
+// Reads either a job file in our own format, or a classic instance: BPP files
+// (piece count, bar capacity, one piece length per line) and cutting stock files
+// (length count, bar capacity, one "length demand" pair per line).
+bool loadInstanceFile(const std::string &fileName, BenchInstance &instance, std::string *errorMessage);
+
+#endif // INSTANCES_H
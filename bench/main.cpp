@@ -0,0 +1,298 @@
+// Benchmark front end: solves seeded and classic cutting stock instances with
+// every solver mode and prints one machine-readable line per run, so releases
+// can be compared for speed and for material used.
+
+#include "cutting_job.h"
+#include "cutting_solver.h"
+#include "instances.h"
+#include "solve_stats.h"
+#include "text_escape.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+struct BenchRow {
+    const BenchInstance *instance = nullptr;
+    SolverMode mode = SolverMode::Greedy;
+    long long pieces = 0;
+    long long bars = 0;
+    long long lowerBound = 0;   // In bars; 0 when the instance has more than one bar length
+    double gapPercent = 0.0;    // Stock cut above the solver's lower bound
+    long long missingPieces = 0;
+    double wastePercent = 0.0;
+    double seconds = 0.0;
+    long long peakMemoryKb = 0;  // Of the process that ran this instance alone, see runIsolated
+    bool stoppedEarly = false;
+};
+static_assert(std::is_trivially_copyable<BenchRow>::value, "rows are passed back from child processes as bytes");
+
+static void printUsage(const char *program) {
+    std::cerr << "Usage: " << program << " [--suite quick|full|none] [--seeds <n>] [--modes greedy,bfd,cg,lns] [-t <seconds>] [-u <unit>] [--json] [-o <file>] [<instance-file>...]\n"
+              << "Generates the instances of the suite for seeds 1 to <n> (default 3), adds the given files,\n"
+              << "solves each with every mode and prints one CSV line (or JSON object with --json) per run.\n"
+              << "Instance files are job files or classic bin packing / cutting stock instances.\n"
+              << "Each run is solved in a child process of its own, whose peak memory is reported; on Windows\n"
+              << "the runs share the benchmark's process and peak_memory_kb is the peak of all runs so far.\n"
+              << "Generator families: uniform, triplet, falkenauer, small-cuts.\n";
+}
+
+// The solver's stock lower bound as a number of bars, when every bar has the same length
+static long long lowerBoundBars(const CuttingJob &job, const CuttingResult &result) {
+    if (job.stock.empty())
+        return 0;
+    double barLength = job.stock.front().length;
+    for (const StockEntry &entry : job.stock) {
+        if (entry.length != barLength)
+            return 0;
+    }
+    return static_cast<long long>(std::ceil(result.stockLowerBound / barLength - 1e-9));
+}
+
+static BenchRow runInstance(const BenchInstance &instance, SolverMode mode, const SolverOptions &baseOptions) {
+    SolverOptions options = baseOptions;
+    options.mode = mode;
+
+    BenchRow row;
+    row.instance = &instance;
+    row.mode = mode;
+    for (const CutEntry &entry : instance.job.cuts)
+        row.pieces += entry.quantity;
+
+    auto start = std::chrono::steady_clock::now();
+    CuttingResult result = solveCuttingJob(instance.job, options);
+    row.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double barLength = 0.0;
+    for (const CuttingScheme &scheme : result.schemes) {
+        row.bars += scheme.count;
+        barLength += scheme.stockLength * scheme.count;
+    }
+    for (const Shortage &shortage : result.shortages)
+        row.missingPieces += shortage.quantity;
+    // usedStockLength is the length that went into pieces; the rest of the bars cut is waste
+    if (barLength > 0)
+        row.wastePercent = 100.0 * (barLength - result.usedStockLength) / barLength;
+    row.lowerBound = lowerBoundBars(instance.job, result);
+    row.gapPercent = result.gapPercent();
+    row.stoppedEarly = result.stoppedEarly;
+    return row;
+}
+
+// The peak resident memory of a process only ever grows, so on POSIX systems
+// each run forks a child that solves and sends its row back, and the peak
+// comes from wait4. The child starts as a copy of the benchmark, instances and
+// all, so that much is part of every peak. Returns false when the child failed.
+static bool runIsolated(const BenchInstance &instance, SolverMode mode, const SolverOptions &options, BenchRow &row) {
+#ifndef _WIN32
+    int channel[2];
+    if (pipe(channel) == 0) {
+        const pid_t child = fork();
+        if (child == 0) {
+            close(channel[0]);
+            row = runInstance(instance, mode, options);
+            const bool sent = write(channel[1], &row, sizeof(row)) == static_cast<ssize_t>(sizeof(row));
+            _exit(sent ? 0 : 1);
+        }
+        close(channel[1]);
+        if (child > 0) {
+            std::size_t received = 0;
+            while (received < sizeof(row)) {
+                const ssize_t bytes = read(channel[0], reinterpret_cast<char *>(&row) + received, sizeof(row) - received);
+                if (bytes <= 0)
+                    break;
+                received += static_cast<std::size_t>(bytes);
+            }
+            close(channel[0]);
+            int status = 0;
+            struct rusage usage;
+            if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0
+                || received != sizeof(row))
+                return false;
+#ifdef __APPLE__
+            row.peakMemoryKb = usage.ru_maxrss / 1024;  // Bytes on macOS
+#else
+            row.peakMemoryKb = usage.ru_maxrss;
+#endif
+            return true;
+        }
+        close(channel[0]);
+    }
+#endif
+    row = runInstance(instance, mode, options);
+    row.peakMemoryKb = processPeakMemoryKb();
+    return true;
+}
+
+static const char *csvHeader =
+    "instance,family,seed,mode,lengths,pieces,bars,lower_bound,gap_percent,waste_percent,missing_pieces,seconds,peak_memory_kb,stopped_early";
+
+static void printRow(std::ostream &out, const BenchRow &row, bool json) {
+    const BenchInstance &instance = *row.instance;
+    std::ostringstream line;
+    line << std::fixed;
+    if (json) {
+        line << "{\"instance\":" << jsonString(instance.name)
+             << ",\"family\":" << jsonString(instance.family)
+             << ",\"seed\":" << instance.seed
+             << ",\"mode\":" << jsonString(solverModeName(row.mode))
+             << ",\"lengths\":" << instance.job.cuts.size()
+             << ",\"pieces\":" << row.pieces
+             << ",\"bars\":" << row.bars
+             << ",\"lower_bound\":" << row.lowerBound
+             << std::setprecision(3)
+             << ",\"gap_percent\":" << row.gapPercent
+             << ",\"waste_percent\":" << row.wastePercent
+             << ",\"missing_pieces\":" << row.missingPieces
+             << std::setprecision(6)
+             << ",\"seconds\":" << row.seconds
+             << ",\"peak_memory_kb\":" << row.peakMemoryKb
+             << ",\"stopped_early\":" << (row.stoppedEarly ? "true" : "false") << "}";
+    } else {
+        line << csvField(instance.name) << ',' << instance.family << ',' << instance.seed << ','
+             << solverModeName(row.mode) << ',' << instance.job.cuts.size() << ',' << row.pieces << ','
+             << row.bars << ',' << row.lowerBound << ','
+             << std::setprecision(3) << row.gapPercent << ',' << row.wastePercent << ','
+             << row.missingPieces << ','
+             << std::setprecision(6) << row.seconds << ',' << row.peakMemoryKb << ','
+             << (row.stoppedEarly ? 1 : 0);
+    }
+    out << line.str() << "\n" << std::flush;
+}
+
+static bool parseModes(const std::string &list, std::vector<SolverMode> &modes) {
+    modes.clear();
+    std::istringstream in(list);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        SolverMode mode;
+        if (!parseSolverMode(name, mode))
+            return false;
+        modes.push_back(mode);
+    }
+    return !modes.empty();
+}
+
+// Instance sizes per family. The quick suite runs in seconds and is meant for
+// every change; the full suite adds the sizes where the solvers differ most.
+static std::vector<int> suiteSizes(const std::string &suite, const std::string &family) {
+    bool full = suite == "full";
+    if (family == "uniform")
+        return full ? std::vector<int>{20, 40, 60} : std::vector<int>{20};
+    if (family == "triplet")
+        return full ? std::vector<int>{60, 120, 249, 501} : std::vector<int>{60, 120};
+    if (family == "falkenauer")
+        return full ? std::vector<int>{120, 250, 500, 1000} : std::vector<int>{120, 250};
+    if (family == "small-cuts")
+        return full ? std::vector<int>{50, 200, 500} : std::vector<int>{50};
+    return {};
+}
+
+int main(int argc, char *argv[]) {
+    std::string suite = "quick";
+    int seedCount = 3;
+    std::vector<SolverMode> modes = {SolverMode::Greedy, SolverMode::BestFit, SolverMode::ColumnGeneration, SolverMode::LocalSearch};
+    std::vector<std::string> instanceFiles;
+    std::string outputFile;
+    bool json = false;
+    SolverOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--suite" && i + 1 < argc) {
+            suite = argv[++i];
+            if (suite != "quick" && suite != "full" && suite != "none") {
+                std::cerr << "Unknown suite: " << suite << "\n";
+                return 2;
+            }
+        } else if (arg == "--seeds" && i + 1 < argc) {
+            seedCount = std::atoi(argv[++i]);
+        } else if ((arg == "-m" || arg == "--modes") && i + 1 < argc) {
+            if (!parseModes(argv[++i], modes)) {
+                std::cerr << "Unknown solver mode in: " << argv[i] << "\n";
+                return 2;
+            }
+        } else if ((arg == "-t" || arg == "--time-limit") && i + 1 < argc) {
+            options.timeLimit = std::atof(argv[++i]);
+        } else if ((arg == "-u" || arg == "--unit") && i + 1 < argc) {
+            options.lengthUnit = std::atof(argv[++i]);
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--csv") {
+            json = false;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] != '-') {
+            instanceFiles.push_back(arg);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Instances are built up front so that generation is not part of any timing
+    std::vector<BenchInstance> instances;
+    if (suite != "none") {
+        for (const std::string &family : generatorFamilies()) {
+            for (int size : suiteSizes(suite, family)) {
+                for (int seed = 1; seed <= seedCount; ++seed) {
+                    instances.emplace_back();
+                    generateInstance(family, size, static_cast<std::uint64_t>(seed), instances.back());
+                }
+            }
+        }
+    }
+    for (const std::string &fileName : instanceFiles) {
+        BenchInstance instance;
+        std::string errorMessage;
+        if (!loadInstanceFile(fileName, instance, &errorMessage)) {
+            std::cerr << errorMessage << "\n";
+            return 1;
+        }
+        instances.push_back(std::move(instance));
+    }
+    if (instances.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!outputFile.empty()) {
+        file.open(outputFile);
+        if (!file) {
+            std::cerr << "Cannot write " << outputFile << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outputFile.empty() ? std::cout : file;
+
+    if (!json)
+        out << csvHeader << "\n";
+    for (const BenchInstance &instance : instances) {
+        for (SolverMode mode : modes) {
+            BenchRow row;
+            if (!runIsolated(instance, mode, options, row)) {
+                std::cerr << "Solving " << instance.name << " with " << solverModeName(mode) << " failed\n";
+                return 1;
+            }
+            printRow(out, row, json);
+        }
+    }
+    return 0;
+}
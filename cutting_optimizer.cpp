@@ -5,8 +5,8 @@
 #include <QMessageBox>
 #include <QWidget>
 #include <vector>
-#include <algorithm>
-#include <iostream>
+
+#include "cutting_solver.h"
 
 // Data structure for storing stock profiles and cut list profiles
 struct Profile {
@@ -31,7 +31,7 @@ private:
 
     std::vector<Profile> getStockProfiles();
     std::vector<Profile> getCutList();
-    void showResult(const std::vector<std::pair<int, int>>& result, int totalWaste);
+    void showResult(const CuttingResult &result);
 };
 
 // Constructor for the Cutting Optimizer
@@ -87,57 +87,47 @@ std::vector<Profile> CuttingOptimizer::getCutList() {
     return cutList;
 }
 
-// Optimization algorithm: simple greedy method
+// Optimization: the same solver as the main window, on one unnamed profile.
+// Lengths are whole numbers here, so the solver works in steps of 1.
 void CuttingOptimizer::optimizeCuts() {
-    std::vector<Profile> stock = getStockProfiles();
-    std::vector<Profile> cuts = getCutList();
-
-    std::vector<std::pair<int, int>> result;  // store <cut length, stock length>
-    int totalWaste = 0;
-
-    // Sort stock profiles by length (ascending order)
-    std::sort(stock.begin(), stock.end(), [](const Profile &a, const Profile &b) {
-        return a.length < b.length;
-    });
-
-    // Simple greedy algorithm
-    for (const auto &cut : cuts) {
-        int neededQuantity = cut.quantity;
-        int cutLength = cut.length;
-
-        for (auto &stockProfile : stock) {
-            while (stockProfile.quantity > 0 && neededQuantity > 0) {
-                if (stockProfile.length >= cutLength) {
-                    // Use this stock piece for the cut
-                    result.push_back({cutLength, stockProfile.length});
-                    stockProfile.quantity--;
-                    neededQuantity--;
-
-                    // Calculate waste
-                    totalWaste += stockProfile.length - cutLength;
-                } else {
-                    break;  // Move to next available stock
-                }
-            }
-        }
-
-        if (neededQuantity > 0) {
-            QMessageBox::warning(this, "Optimization Error", "Not enough stock to fulfill the cut list.");
-            return;
-        }
+    CuttingJob job;
+    for (const auto &stock : getStockProfiles())
+        job.stock.push_back({std::string(), stock.quantity, static_cast<double>(stock.length)});
+    for (const auto &cut : getCutList())
+        job.cuts.push_back({std::string(), static_cast<double>(cut.length), cut.quantity});
+
+    SolverOptions options;
+    options.lengthUnit = 1.0;
+    CuttingResult result = solveCuttingJob(job, options);
+
+    if (!result.shortages.empty()) {
+        QMessageBox::warning(this, "Optimization Error", "Not enough stock to fulfill the cut list.");
+        return;
     }
 
     // Show the result
-    showResult(result, totalWaste);
+    showResult(result);
 }
 
-// Display the optimization result in a message box
-void CuttingOptimizer::showResult(const std::vector<std::pair<int, int>>& result, int totalWaste) {
-    QString message;
-    for (const auto &pair : result) {
-        message += QString("Cut length %1 from stock length %2\n").arg(pair.first).arg(pair.second);
+// Display the optimization result in a message box. A message box is no place
+// for a big plan, so only the first schemes are listed; the rest are counted.
+void CuttingOptimizer::showResult(const CuttingResult &result) {
+    const size_t maxListedSchemes = 40;
+    QStringList lines;
+    double totalWaste = 0.0;
+    for (const auto &scheme : result.schemes) {
+        totalWaste += scheme.remainder * scheme.count;
+        if (static_cast<size_t>(lines.size()) == maxListedSchemes)
+            continue;
+        QStringList cuts;
+        for (double cut : scheme.cuts)
+            cuts << QString::number(cut);
+        lines << QString("%1 x cut lengths %2 from stock length %3")
+                     .arg(scheme.count).arg(cuts.join(" + ")).arg(scheme.stockLength);
     }
-    message += QString("\nTotal waste: %1").arg(totalWaste);
+    if (result.schemes.size() > maxListedSchemes)
+        lines << QString("... and %1 more schemes").arg(result.schemes.size() - maxListedSchemes);
+    QString message = lines.join("\n") + QString("\n\nTotal waste: %1").arg(totalWaste);
 
     QMessageBox::information(this, "Optimization Result", message);
 }
@@ -8,13 +8,21 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(solver/solver.pri)
+
 SOURCES += \
     cutting_optimizer.cpp \
+    jobtablemodel.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    optimizationworker.cpp \
+    resultlistmodel.cpp
 
 HEADERS += \
-    mainwindow.h
+    jobtablemodel.h \
+    mainwindow.h \
+    optimizationworker.h \
+    resultlistmodel.h
 
 FORMS += \
     mainwindow.ui
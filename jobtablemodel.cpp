@@ -0,0 +1,144 @@
+#include "jobtablemodel.h"
+
+JobTableModel::JobTableModel(Layout layout, QObject *parent) : QAbstractTableModel(parent), layout(layout) {
+}
+
+int JobTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(names.size());
+}
+
+int JobTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : (layout == StockLayout ? 4 : 3);
+}
+
+bool JobTableModel::isLengthColumn(int column) const {
+    return column == (layout == StockLayout ? 2 : 1);
+}
+
+bool JobTableModel::isCostColumn(int column) const {
+    return layout == StockLayout && column == 3;
+}
+
+QVariant JobTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+
+    const size_t row = index.row();
+    if (index.column() == 0)
+        return QString::fromStdString(names[row]);
+    if (isLengthColumn(index.column()))
+        return lengths[row];
+    if (isCostColumn(index.column()))
+        return costs[row];
+    return quantities[row];
+}
+
+QVariant JobTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation == Qt::Vertical)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    if (section == 0)
+        return QString("Profile Name");
+    if (isLengthColumn(section))
+        return QString(layout == StockLayout ? "Standard Length" : "Length to Cut");
+    if (isCostColumn(section))
+        return QString("Cost per Bar");
+    return QString("Quantity");
+}
+
+bool JobTableModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+    if (!index.isValid() || role != Qt::EditRole)
+        return false;
+
+    // Numbers typed as text are checked here, nothing invalid reaches the solver
+    const size_t row = index.row();
+    bool ok = true;
+    if (index.column() == 0) {
+        names[row] = value.toString().toStdString();
+    } else if (isLengthColumn(index.column())) {
+        double length = value.toDouble(&ok);
+        if (!ok)
+            return false;
+        lengths[row] = length;
+    } else if (isCostColumn(index.column())) {
+        double cost = value.toDouble(&ok);
+        if (!ok || cost < 0)
+            return false;
+        costs[row] = cost;
+    } else {
+        int quantity = value.toInt(&ok);
+        if (!ok)
+            return false;
+        quantities[row] = quantity;
+    }
+
+    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+    return true;
+}
+
+Qt::ItemFlags JobTableModel::flags(const QModelIndex &index) const {
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable;
+}
+
+void JobTableModel::appendRow() {
+    const int row = rowCount();
+    beginInsertRows(QModelIndex(), row, row);
+    names.emplace_back();
+    lengths.push_back(0.0);
+    quantities.push_back(0);
+    if (layout == StockLayout)
+        costs.push_back(0.0);
+    endInsertRows();
+}
+
+void JobTableModel::clear() {
+    beginResetModel();
+    names.clear();
+    lengths.clear();
+    quantities.clear();
+    costs.clear();
+    endResetModel();
+}
+
+void JobTableModel::setRows(const CuttingJob &job) {
+    beginResetModel();
+    names.clear();
+    lengths.clear();
+    quantities.clear();
+    costs.clear();
+
+    if (layout == StockLayout) {
+        names.reserve(job.stock.size());
+        lengths.reserve(job.stock.size());
+        quantities.reserve(job.stock.size());
+        costs.reserve(job.stock.size());
+        for (const auto &stock : job.stock) {
+            names.push_back(stock.profileName);
+            lengths.push_back(stock.length);
+            quantities.push_back(stock.quantity);
+            costs.push_back(stock.cost);
+        }
+    } else {
+        names.reserve(job.cuts.size());
+        lengths.reserve(job.cuts.size());
+        quantities.reserve(job.cuts.size());
+        for (const auto &cut : job.cuts) {
+            names.push_back(cut.profileName);
+            lengths.push_back(cut.lengthToCut);
+            quantities.push_back(cut.quantity);
+        }
+    }
+    endResetModel();
+}
+
+void JobTableModel::addRowsTo(CuttingJob &job) const {
+    for (size_t row = 0; row < names.size(); ++row) {
+        if (layout == StockLayout) {
+            job.stock.push_back({names[row], quantities[row], lengths[row], costs[row]});
+        } else {
+            job.cuts.push_back({names[row], lengths[row], quantities[row]});
+        }
+    }
+}
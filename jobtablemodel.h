@@ -0,0 +1,49 @@
+#ifndef JOBTABLEMODEL_H
+#define JOBTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <string>
+#include <vector>
+
+#include "cutting_job.h"
+
+// Backing store of the stock and profile tables. Each column is a plain array,
+// and text is only made for the rows the view actually shows, so orders with
+// hundreds of thousands of rows load and solve without per-cell objects.
+class JobTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Layout {
+        StockLayout,  // Profile Name, Quantity, Standard Length, Cost per Bar
+        CutLayout     // Profile Name, Length to Cut, Quantity
+    };
+
+    explicit JobTableModel(Layout layout, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    void appendRow();  // Empty name, zero quantity, length and cost
+    void clear();
+
+    // Whole tables at once: from the stock or cuts of a job, depending on the layout
+    void setRows(const CuttingJob &job);
+    void addRowsTo(CuttingJob &job) const;
+
+private:
+    bool isLengthColumn(int column) const;
+    bool isCostColumn(int column) const;
+
+    Layout layout;
+    std::vector<std::string> names;
+    std::vector<double> lengths;
+    std::vector<int> quantities;
+    std::vector<double> costs;  // Stock only; 0 when the bar has no price
+};
+
+#endif // JOBTABLEMODEL_H
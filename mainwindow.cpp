@@ -1,82 +1,186 @@
 #include "mainwindow.h"
+#include "cutting_solver.h"
+#include "remnant_store.h"
+#include "result_writer.h"
 #include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
 #include <QPushButton>
 #include <QMessageBox>
 #include <QFileDialog>
-#include <QTextStream>
+#include <QFile>
 #include <QPainter>
 #include <QColor>
+#include <QWheelEvent>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFontDatabase>
+#include <QStandardPaths>
 #include <algorithm>
+#include <climits>
+#include <map>
 #include <set>   // Add this line to include the std::set
 
 
 // Custom Widget for Drawing the Cutting Scheme with Full Rectangle Bars
+namespace {
+
+const int headerHeight = 24;   // Room for the length axis
+const int labelWidth = 150;    // Bar count and profile name left of each bar
+const int minRowHeight = 2;
+const int maxRowHeight = 60;
+
+// Define some colors for different profiles
+const QList<QColor> profileColors = {Qt::red, Qt::green, Qt::blue, Qt::cyan, Qt::magenta, Qt::yellow};
+
+} // namespace
+
 CuttingChartWidget::CuttingChartWidget(QWidget *parent) : QWidget(parent) {
+    scrollBar = new QScrollBar(Qt::Vertical, this);
+    connect(scrollBar, &QScrollBar::valueChanged, this, &CuttingChartWidget::invalidate);
+    updateScrollBar();
 }
 
 // Set the cutting data for the chart and trigger a repaint
-void CuttingChartWidget::setCuttingData(const std::map<QString, std::vector<double>> &data) {
-    cuttingData = data;
-    update(); // Request a repaint
-}
-
-// Paint the cutting chart using QPainter with colors
-void CuttingChartWidget::paintEvent(QPaintEvent *event) {
-    Q_UNUSED(event);
-
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+void CuttingChartWidget::setCuttingResult(const CuttingResult &result) {
+    schemes = result.schemes;
+    colorIndices.clear();
+    longestStock = 0.0;
+
+    std::map<std::string, int> profileIndices;
+    for (const auto &scheme : schemes) {
+        auto inserted = profileIndices.emplace(scheme.profileName, static_cast<int>(profileIndices.size()));
+        colorIndices.push_back(inserted.first->second);
+        longestStock = std::max(longestStock, scheme.stockLength);
+    }
 
-    int margin = 50;
-    int maxHeight = height() - 2 * margin;
-    int maxWidth = width() - 2 * margin;
+    updateScrollBar();
+    invalidate();
+}
 
-    painter.setFont(QFont("Arial", 10));
+void CuttingChartWidget::invalidate() {
+    cacheValid = false;
+    update(); // Request a repaint
+}
 
-    // Draw the axes
-    painter.drawLine(margin, height() - margin, margin, margin);  // Y-axis
-    painter.drawLine(margin, height() - margin, width() - margin, height() - margin);  // X-axis
+void CuttingChartWidget::updateScrollBar() {
+    const int pageHeight = std::max(0, height() - headerHeight);
+    const int contentHeight = static_cast<int>(std::min<size_t>(schemes.size() * rowHeight, INT_MAX / 2));
+    scrollBar->setRange(0, std::max(0, contentHeight - pageHeight));
+    scrollBar->setPageStep(pageHeight);
+    scrollBar->setSingleStep(rowHeight);
+}
 
-    // Labels for axes
-    painter.drawText(margin - 40, margin, "Length (m)");
-    painter.drawText(width() - margin + 10, height() - margin + 10, "Profiles");
+void CuttingChartWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    const int barWidth = scrollBar->sizeHint().width();
+    scrollBar->setGeometry(width() - barWidth, headerHeight, barWidth, std::max(0, height() - headerHeight));
+    updateScrollBar();
+    invalidate();
+}
 
-    // Define some colors for different profiles
-    QList<QColor> colors = {Qt::red, Qt::green, Qt::blue, Qt::cyan, Qt::magenta, Qt::yellow};
-    int colorIndex = 0;
+// Wheel scrolls, Ctrl + wheel zooms around the row under the mouse
+void CuttingChartWidget::wheelEvent(QWheelEvent *event) {
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QCoreApplication::sendEvent(scrollBar, event);
+        return;
+    }
 
-    // Draw the cutting bars with colors
-    int profileIndex = 0;
-    int profileSpacing = maxWidth / (cuttingData.size() + 1);
+    const int steps = event->angleDelta().y() / 120;
+    const int newRowHeight = std::clamp(steps > 0 ? rowHeight * 5 / 4 + 1 : rowHeight * 4 / 5, minRowHeight, maxRowHeight);
+    if (steps == 0 || newRowHeight == rowHeight)
+        return;
 
-    for (const auto &entry : cuttingData) {
-        QString profileName = entry.first;
-        const std::vector<double> &cuts = entry.second;
+    const double anchor = (scrollBar->value() + event->position().y() - headerHeight) / rowHeight;
+    rowHeight = newRowHeight;
+    updateScrollBar();
+    scrollBar->setValue(static_cast<int>(anchor * rowHeight - (event->position().y() - headerHeight)));
+    invalidate();
+    event->accept();
+}
 
-        int xPos = margin + profileSpacing * (++profileIndex);
-        painter.drawText(xPos - 20, height() - margin + 20, profileName);
+void CuttingChartWidget::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
 
-        // Draw each cut as a full rectangle for this profile
-        int yPosBase = height() - margin;
-        int barWidth = 40;
-        int currentYOffset = 0;
+    if (!cacheValid)
+        renderChart();
 
-        QColor color = colors[colorIndex % colors.size()];
-        colorIndex++;
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, cache);
+}
 
-        for (double cut : cuts) {
-            int barHeight = static_cast<int>((cut / 10.0) * maxHeight);  // Scale length to fit chart
-            QRect barRect(xPos - barWidth / 2, yPosBase - currentYOffset - barHeight, barWidth, barHeight);
+// Paint the cutting chart using QPainter with colors. Text and borders are left
+// out as rows get too small to show them.
+void CuttingChartWidget::renderChart() {
+    PhaseTimer timer(stats, "render: chart");
+    const qreal ratio = devicePixelRatioF();
+    cache = QPixmap(size() * ratio);
+    cache.setDevicePixelRatio(ratio);
+    cache.fill(palette().color(QPalette::Base));
+    cacheValid = true;
+
+    QPainter painter(&cache);
+    painter.setFont(QFont("Arial", 10));
+    const QFontMetrics metrics = painter.fontMetrics();
+
+    const int plotLeft = labelWidth;
+    const int plotWidth = std::max(1, width() - plotLeft - scrollBar->width() - 10);
+
+    // Length axis along the top, scaled to the longest stock bar
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawLine(plotLeft, headerHeight - 4, plotLeft + plotWidth, headerHeight - 4);
+    painter.drawText(4, headerHeight - 8, "Length");
+    if (longestStock > 0) {
+        painter.drawText(plotLeft, headerHeight - 8, "0");
+        QString longest = QString::fromStdString(formatLength(longestStock));
+        painter.drawText(plotLeft + plotWidth - metrics.horizontalAdvance(longest), headerHeight - 8, longest);
+    }
+    if (schemes.empty() || longestStock <= 0)
+        return;
 
-            painter.setBrush(color);
-            painter.setPen(color);
-            painter.drawRect(barRect);
+    painter.setClipRect(0, headerHeight, width() - scrollBar->width(), height() - headerHeight);
+    const double scale = plotWidth / longestStock;
+    const int top = scrollBar->value();
+    const size_t firstRow = top / rowHeight;
+    const size_t lastRow = std::min(schemes.size(), static_cast<size_t>((top + height() - headerHeight) / rowHeight + 1));
+    const qreal gap = rowHeight >= 6 ? 2 : 0;
+    const bool drawLabels = rowHeight >= metrics.height();
+    const bool drawCuts = rowHeight >= 4;
+
+    for (size_t row = firstRow; row < lastRow; ++row) {
+        const CuttingScheme &scheme = schemes[row];
+        const QColor color = profileColors[colorIndices[row] % profileColors.size()];
+        const qreal y = headerHeight + static_cast<qreal>(row) * rowHeight - top;
+        const qreal barHeight = rowHeight - gap;
+
+        if (drawLabels) {
+            painter.setPen(palette().color(QPalette::Text));
+            QString label = QString("%1 x  %2").arg(scheme.count).arg(QString::fromStdString(scheme.profileName));
+            painter.drawText(QRectF(4, y, labelWidth - 8, barHeight), Qt::AlignVCenter | Qt::AlignLeft,
+                             metrics.elidedText(label, Qt::ElideRight, labelWidth - 8));
+        }
 
-            // Label the cut length above the bar
-            painter.setPen(Qt::black);
-            painter.drawText(xPos - 10, yPosBase - currentYOffset - barHeight - 5, QString("%1 m").arg(cut, 0, 'f', 1));
+        // Remainder first, the whole bar in grey, then the cuts over it
+        painter.fillRect(QRectF(plotLeft, y, scheme.stockLength * scale, barHeight), Qt::lightGray);
+        if (!drawCuts) {
+            painter.fillRect(QRectF(plotLeft, y, (scheme.stockLength - scheme.remainder) * scale, barHeight), color);
+            continue;
+        }
 
-            currentYOffset += barHeight; // Move up for next cut
+        qreal x = plotLeft;
+        for (size_t i = 0; i < scheme.cuts.size(); ++i) {
+            const qreal cutWidth = scheme.cuts[i] * scale;
+            const QRectF cutRect(x, y, cutWidth, barHeight);
+            painter.fillRect(cutRect, i % 2 == 0 ? color : color.darker(130));
+
+            if (drawLabels) {
+                QString text = QString::fromStdString(formatLength(scheme.cuts[i]));
+                if (metrics.horizontalAdvance(text) + 4 <= cutWidth) {
+                    painter.setPen(Qt::black);
+                    painter.drawText(cutRect, Qt::AlignCenter, text);
+                }
+            }
+            x += cutWidth;
         }
     }
 }
@@ -92,8 +196,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QVBoxLayout *layout = new QVBoxLayout(centralWidget);
 
     // Stock Table
-    stockTable = new QTableWidget(0, 3, this);
-    stockTable->setHorizontalHeaderLabels({"Profile Name", "Quantity", "Standard Length"});
+    stockModel = new JobTableModel(JobTableModel::StockLayout, this);
+    stockTable = new QTableView(this);
+    stockTable->setModel(stockModel);
+    stockTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);  // No per-row measuring on big orders
     layout->addWidget(stockTable);
 
     // Add row button for Stock Table
@@ -102,8 +208,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     layout->addWidget(addStockButton);
 
     // Profile Table
-    profileTable = new QTableWidget(0, 3, this);
-    profileTable->setHorizontalHeaderLabels({"Profile Name", "Length to Cut", "Quantity"});
+    profileModel = new JobTableModel(JobTableModel::CutLayout, this);
+    profileTable = new QTableView(this);
+    profileTable->setModel(profileModel);
+    profileTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     layout->addWidget(profileTable);
 
     // Add row button for Profile Table
@@ -112,25 +220,82 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     layout->addWidget(addProfileButton);
 
     // Result Area
-    resultArea = new QTextEdit(this);
-    resultArea->setReadOnly(true);
-    layout->addWidget(resultArea);
+    resultModel = new ResultListModel(this);
+    resultView = new QListView(this);
+    resultView->setModel(resultModel);
+    resultView->setUniformItemSizes(true);  // No per-row measuring on big plans
+    resultView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    layout->addWidget(resultView);
 
     // Custom widget for displaying cutting scheme graphically
     chartWidget = new CuttingChartWidget(this);
     layout->addWidget(chartWidget);
 
+    // Solver selection next to the "Optimize" button, so both can be run on the same input
+    QHBoxLayout *optimizeLayout = new QHBoxLayout();
+    solverModeBox = new QComboBox(this);
+    solverModeBox->addItem("Greedy (fullest bar first)", static_cast<int>(SolverMode::Greedy));
+    solverModeBox->addItem("Best fit (fastest)", static_cast<int>(SolverMode::BestFit));
+    solverModeBox->addItem("Column generation", static_cast<int>(SolverMode::ColumnGeneration));
+    solverModeBox->addItem("Local search", static_cast<int>(SolverMode::LocalSearch));
+    optimizeLayout->addWidget(solverModeBox);
+
     // "Optimize" button
     optimizeButton = new QPushButton("Optimize", this);
     connect(optimizeButton, &QPushButton::clicked, this, &MainWindow::optimizeCuts);
-    layout->addWidget(optimizeButton);
+    optimizeLayout->addWidget(optimizeButton, 1);
+
+    // Time budget; when it runs out the best plan found so far is shown
+    timeLimitBox = new QSpinBox(this);
+    timeLimitBox->setRange(0, 3600);
+    timeLimitBox->setSuffix(" s");
+    timeLimitBox->setSpecialValueText("No time limit");
+    optimizeLayout->addWidget(timeLimitBox);
+
+    // Offcuts booked from earlier plans are cut before any new bar
+    useOffcutsBox = new QCheckBox("Use offcuts", this);
+    optimizeLayout->addWidget(useOffcutsBox);
+
+    // "Cancel" button, only enabled while an optimization runs
+    cancelButton = new QPushButton("Cancel", this);
+    cancelButton->setEnabled(false);
+    connect(cancelButton, &QPushButton::clicked, this, &MainWindow::cancelOptimization);
+    optimizeLayout->addWidget(cancelButton);
+    layout->addLayout(optimizeLayout);
+
+    progressBar = new QProgressBar(this);
+    progressBar->setRange(0, 100);
+    progressBar->setValue(0);
+    layout->addWidget(progressBar);
+
+    // Where the last run spent its time
+    statsArea = new QPlainTextEdit(this);
+    statsArea->setReadOnly(true);
+    statsArea->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    statsArea->setMaximumHeight(120);
+    statsArea->setPlaceholderText("Solver statistics of the last run");
+    layout->addWidget(statsArea);
+    chartWidget->setStats(&solveStats);
 
     // Create the menu
     createMenu();
+
+    // A solve the last session did not finish, because the window was closed
+    // or the program died, carries on from its checkpoint on the next
+    // "Optimize" of the same tables and settings
+    const std::string checkpoint = checkpointFile();
+    if (QFile::exists(QFile::decodeName(checkpoint.c_str())))
+        solveCache.load(checkpoint);
 }
 
 MainWindow::~MainWindow() {
-    // Destructor
+    // Do not leave a solve running behind a closed window
+    if (solveThread) {
+        if (solveWorker)
+            solveWorker->cancel();
+        solveThread->quit();
+        solveThread->wait();
+    }
 }
 
 // Create the menu with "File" options for saving and loading
@@ -144,283 +309,204 @@ void MainWindow::createMenu() {
     QAction *loadAction = new QAction(tr("Load Tables"), this);
     connect(loadAction, &QAction::triggered, this, &MainWindow::loadTableData);
     fileMenu->addAction(loadAction);
+
+    QAction *exportResultAction = new QAction(tr("Export Result"), this);
+    connect(exportResultAction, &QAction::triggered, this, &MainWindow::exportResult);
+    fileMenu->addAction(exportResultAction);
+
+    QAction *exportStatsAction = new QAction(tr("Export Solver Stats"), this);
+    connect(exportStatsAction, &QAction::triggered, this, &MainWindow::exportStats);
+    fileMenu->addAction(exportStatsAction);
+
+    QAction *keepOffcutsAction = new QAction(tr("Keep Offcuts of Plan"), this);
+    connect(keepOffcutsAction, &QAction::triggered, this, &MainWindow::keepOffcuts);
+    fileMenu->addAction(keepOffcutsAction);
 }
 
-// Save the data from both stock and profile tables to a file
-void MainWindow::saveTableData() {
-    QString fileName = QFileDialog::getSaveFileName(this, "Save Table Data", "", "Text Files (*.txt);;All Files (*)");
+// JSON totals, or every phase as a Chrome trace for chrome://tracing or Perfetto
+void MainWindow::exportStats() {
+    QString selectedFilter;
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Solver Stats", "",
+                                                    "Stats (*.json);;Chrome Trace (*.trace.json)", &selectedFilter);
     if (fileName.isEmpty()) return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "Error", "Cannot save file: " + file.errorString());
-        return;
+    std::string errorMessage;
+    const std::string file = QFile::encodeName(fileName).toStdString();
+    bool trace = selectedFilter.startsWith("Chrome") || fileName.endsWith(".trace.json");
+    if (!(trace ? solveStats.saveChromeTrace(file, &errorMessage) : solveStats.saveJson(file, &errorMessage))) {
+        QMessageBox::warning(this, "Error", QString::fromStdString(errorMessage));
     }
+}
 
-    QTextStream out(&file);
-
-    // Save stock table data
-    out << "Stock Table:\n";
-    for (int row = 0; row < stockTable->rowCount(); ++row) {
-        for (int col = 0; col < stockTable->columnCount(); ++col) {
-            if (stockTable->item(row, col) != nullptr)
-                out << stockTable->item(row, col)->text() << (col == 2 ? "\n" : ",");
-        }
+// The format follows the filter chosen, or else the extension typed
+void MainWindow::exportResult() {
+    if (resultModel->rowCount() == 0) {
+        QMessageBox::information(this, "Export Result", "Optimize first; the plan shown is exported.");
+        return;
     }
+    QString selectedFilter;
+    QString fileName = QFileDialog::getSaveFileName(
+        this, "Export Result", "",
+        "Report (*.txt);;CSV (*.csv);;JSON (*.json);;Cutting List (*.cutlist);;Binary Result (*.cutres)", &selectedFilter);
+    if (fileName.isEmpty()) return;
 
-    // Save profile table data
-    out << "Profile Table:\n";
-    for (int row = 0; row < profileTable->rowCount(); ++row) {
-        for (int col = 0; col < profileTable->columnCount(); ++col) {
-            if (profileTable->item(row, col) != nullptr)
-                out << profileTable->item(row, col)->text() << (col == 2 ? "\n" : ",");
-        }
+    // The extension inside the filter, such as "*.csv"
+    const QString filterExtension = selectedFilter.section("(*", 1).chopped(1);
+    const std::string file = QFile::encodeName(fileName).toStdString();
+    ResultFormat format = resultFormatOf(file);
+    if (format == ResultFormat::Report && !filterExtension.isEmpty())
+        format = resultFormatOf(filterExtension.toStdString());
+
+    std::string errorMessage;
+    if (!saveResultFile(file, resultModel->result(), format, &errorMessage)) {
+        QMessageBox::warning(this, "Error", QString::fromStdString(errorMessage));
     }
+}
 
-    file.close();
+std::string MainWindow::offcutStoreFile() const {
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(directory);
+    return QFile::encodeName(directory + "/offcuts" + remnantStoreExtension).toStdString();
 }
 
-// Load the data from a file and populate the stock and profile tables
-void MainWindow::loadTableData() {
-    QString fileName = QFileDialog::getOpenFileName(this, "Open Table Data", "", "Text Files (*.txt);;All Files (*)");
-    if (fileName.isEmpty()) return;
+std::string MainWindow::checkpointFile() const {
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(directory);
+    return QFile::encodeName(directory + "/checkpoint" + checkpointExtension).toStdString();
+}
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "Error", "Cannot open file: " + file.errorString());
+// The plan is cut for real: the offcuts it used are gone, and its remainders
+// long enough to use again are kept for the next jobs
+void MainWindow::keepOffcuts() {
+    if (lastResult.schemes.empty()) {
+        QMessageBox::information(this, "Offcuts", "Optimize first; the last plan is booked into the offcut store.");
         return;
     }
+    std::string errorMessage;
+    if (!RemnantStore::update(offcutStoreFile(), lastResult, defaultMinRemnantLength, &errorMessage)) {
+        QMessageBox::warning(this, "Error", QString::fromStdString(errorMessage));
+        return;
+    }
+    lastResult = CuttingResult();  // Booking the same plan twice would remove offcuts it never used
+}
 
-    QTextStream in(&file);
-    QString line;
-    bool loadingStock = true;
-    int stockRow = 0;
-    int profileRow = 0;
+// Save the data from both stock and profile tables to a file
+void MainWindow::saveTableData() {
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Table Data", "", "Text Files (*.txt);;Binary Jobs (*.cutjob);;All Files (*)");
+    if (fileName.isEmpty()) return;
 
-    stockTable->setRowCount(0);  // Clear existing data
-    profileTable->setRowCount(0);  // Clear existing data
+    std::string errorMessage;
+    if (!saveJobFile(QFile::encodeName(fileName).toStdString(), readCuttingJob(), &errorMessage)) {
+        QMessageBox::warning(this, "Error", QString::fromStdString(errorMessage));
+    }
+}
 
-    while (!in.atEnd()) {
-        line = in.readLine();
-        if (line.startsWith("Stock Table:")) {
-            loadingStock = true;
-            continue;
-        } else if (line.startsWith("Profile Table:")) {
-            loadingStock = false;
-            continue;
-        }
+// Load the data from a file and populate the stock and profile tables
+void MainWindow::loadTableData() {
+    QString fileName = QFileDialog::getOpenFileName(this, "Open Table Data", "", "Job Files (*.txt *.cutjob);;All Files (*)");
+    if (fileName.isEmpty()) return;
 
-        QStringList parts = line.split(",");
-        if (parts.size() != 3) continue;  // Invalid format
-
-        if (loadingStock) {
-            stockTable->insertRow(stockRow);
-            stockTable->setItem(stockRow, 0, new QTableWidgetItem(parts[0]));
-            stockTable->setItem(stockRow, 1, new QTableWidgetItem(parts[1]));
-            stockTable->setItem(stockRow, 2, new QTableWidgetItem(parts[2]));
-            stockRow++;
-        } else {
-            profileTable->insertRow(profileRow);
-            profileTable->setItem(profileRow, 0, new QTableWidgetItem(parts[0]));
-            profileTable->setItem(profileRow, 1, new QTableWidgetItem(parts[1]));
-            profileTable->setItem(profileRow, 2, new QTableWidgetItem(parts[2]));
-            profileRow++;
-        }
+    CuttingJob job;
+    std::string errorMessage;
+    if (!loadJobFile(QFile::encodeName(fileName).toStdString(), job, &errorMessage)) {
+        QMessageBox::warning(this, "Error", QString::fromStdString(errorMessage));
+        return;
     }
 
-    file.close();
+    stockModel->setRows(job);
+    profileModel->setRows(job);
 }
 
 void MainWindow::addStockRow() {
-    int currentRow = stockTable->rowCount();
-    stockTable->insertRow(currentRow);
-    stockTable->setItem(currentRow, 0, new QTableWidgetItem(""));
-    stockTable->setItem(currentRow, 1, new QTableWidgetItem("0"));
-    stockTable->setItem(currentRow, 2, new QTableWidgetItem("0.0"));
+    stockModel->appendRow();
+    stockTable->scrollToBottom();
 }
 
 void MainWindow::addProfileRow() {
-    int currentRow = profileTable->rowCount();
-    profileTable->insertRow(currentRow);
-    profileTable->setItem(currentRow, 0, new QTableWidgetItem(""));
-    profileTable->setItem(currentRow, 1, new QTableWidgetItem("0.0"));
-    profileTable->setItem(currentRow, 2, new QTableWidgetItem("0"));
+    profileModel->appendRow();
+    profileTable->scrollToBottom();
 }
 
-void MainWindow::optimizeCuts() {
-    std::vector<std::tuple<QString, int, double>> stockData;
-    std::vector<std::tuple<QString, double, int>> profileData;
-
-    // Get data from stock table
-    for (int row = 0; row < stockTable->rowCount(); ++row) {
-        if (stockTable->item(row, 0) == nullptr || stockTable->item(row, 1) == nullptr || stockTable->item(row, 2) == nullptr) {
-            continue;
-        }
+CuttingJob MainWindow::readCuttingJob() const {
+    // The models hold typed columns, so nothing is parsed here
+    CuttingJob job;
+    stockModel->addRowsTo(job);
+    profileModel->addRowsTo(job);
+    return job;
+}
 
-        QString profileName = stockTable->item(row, 0)->text();
-        int quantity = stockTable->item(row, 1)->text().toInt();
-        double length = stockTable->item(row, 2)->text().toDouble();
-        stockData.emplace_back(profileName, quantity, length);
+void MainWindow::optimizeCuts() {
+    if (solveThread)
+        return;  // Still running, or still shutting down the previous solve
+
+    SolverOptions options;
+    options.mode = static_cast<SolverMode>(solverModeBox->currentData().toInt());
+    options.timeLimit = timeLimitBox->value();
+    options.threads = 0;  // Profile groups on every core
+    options.cache = &solveCache;  // Only one solve runs at a time
+    options.checkpointFile = checkpointFile();
+    options.stats = &solveStats;
+    solveStats.clear();
+    statsArea->clear();
+
+    CuttingJob job;
+    {
+        PhaseTimer timer(&solveStats, "parse");
+        job = readCuttingJob();
     }
 
-    // Get data from profile table
-    for (int row = 0; row < profileTable->rowCount(); ++row) {
-        if (profileTable->item(row, 0) == nullptr || profileTable->item(row, 1) == nullptr || profileTable->item(row, 2) == nullptr) {
-            continue;
-        }
+    // The worker owns a copy of the job, so the tables can be edited while it runs
+    solveThread = new QThread(this);
+    solveWorker = new OptimizationWorker(job, options,
+                                         useOffcutsBox->isChecked() ? offcutStoreFile() : std::string());
+    solveWorker->moveToThread(solveThread);
+
+    connect(solveThread, &QThread::started, solveWorker, &OptimizationWorker::run);
+    connect(solveWorker, &OptimizationWorker::progressChanged, progressBar, &QProgressBar::setValue);
+    connect(solveWorker, &OptimizationWorker::incumbentFound, this, &MainWindow::showCuttingResult);
+    connect(solveWorker, &OptimizationWorker::finished, this, &MainWindow::optimizationFinished);
+    connect(solveWorker, &OptimizationWorker::finished, solveThread, &QThread::quit);
+    connect(solveThread, &QThread::finished, solveWorker, &QObject::deleteLater);
+    connect(solveThread, &QThread::finished, solveThread, &QObject::deleteLater);
+    connect(solveThread, &QThread::finished, this, [this]() { solveThread = nullptr; });
+
+    resultModel->clear();
+    progressBar->setValue(0);
+    optimizeButton->setEnabled(false);
+    cancelButton->setEnabled(true);
+    solveThread->start();
+}
 
-        QString profileName = profileTable->item(row, 0)->text();
-        double lengthToCut = profileTable->item(row, 1)->text().toDouble();
-        int quantity = profileTable->item(row, 2)->text().toInt();
-        profileData.emplace_back(profileName, lengthToCut, quantity);
-    }
+void MainWindow::cancelOptimization() {
+    if (solveWorker)
+        solveWorker->cancel();
+    cancelButton->setEnabled(false);
+}
 
-    resultArea->clear();
-    QString result = performCuttingOptimization(stockData, profileData);
+void MainWindow::optimizationFinished(const CuttingResult &result) {
+    // The worker and its thread delete themselves once the thread has stopped
+    solveWorker = nullptr;
+    lastResult = result;
 
-    resultArea->append("Cutting Scheme:\n");
-    resultArea->append(result);
+    showCuttingResult(result);
+    statsArea->setPlainText(QString::fromStdString(solveStats.summary()));
+    progressBar->setValue(100);
+    optimizeButton->setEnabled(true);
+    cancelButton->setEnabled(false);
 }
 
 void MainWindow::resetTables() {
-    stockTable->setRowCount(0);
-    profileTable->setRowCount(0);
-    resultArea->clear();
-    chartWidget->update();
+    stockModel->clear();
+    profileModel->clear();
+    resultModel->clear();
+    chartWidget->setCuttingResult(CuttingResult());
 }
 
-// Perform cutting optimization
-QString MainWindow::performCuttingOptimization(
-    const std::vector<std::tuple<QString, int, double>> &stockData,
-    const std::vector<std::tuple<QString, double, int>> &profileData) {
-
-    QString result;
-    std::map<QString, std::vector<double>> stockProfiles;
-    std::map<QString, std::vector<double>> cutData;
-
-    double totalStockLength = 0.0;  // Total length of available stock
-    double usedStockLength = 0.0;   // Total length actually used in cutting
-
-    // Group stock profiles by type and length
-    for (const auto &stock : stockData) {
-        QString profileName = std::get<0>(stock);
-        int quantity = std::get<1>(stock);
-        double length = std::get<2>(stock);
-
-        for (int i = 0; i < quantity; ++i) {
-            stockProfiles[profileName].push_back(length);
-            totalStockLength += length;  // Adding total length of all stock profiles
-        }
-    }
-
-    // Sort stock profiles by length in descending order to minimize waste
-    for (auto &entry : stockProfiles) {
-        std::sort(entry.second.begin(), entry.second.end(), std::greater<double>());
-    }
-
-    // Group profiles by name and sort by length to cut
-    std::map<QString, std::vector<std::pair<double, int>>> groupedProfiles;
-    for (const auto &profile : profileData) {
-        QString profileName = std::get<0>(profile);
-        double lengthToCut = std::get<1>(profile);
-        int quantity = std::get<2>(profile);
-
-        groupedProfiles[profileName].emplace_back(lengthToCut, quantity);
-    }
-
-    // Sort each profile's lengths in descending order to maximize stock usage
-    for (auto &entry : groupedProfiles) {
-        std::sort(entry.second.begin(), entry.second.end(), std::greater<>());
-    }
-
-    // Track identical cutting schemes
-    std::map<QString, int> schemeCounts;
-
-    // Process each profile group and try to minimize waste
-    for (const auto &entry : groupedProfiles) {
-        QString profileName = entry.first;
-        const auto &lengthsToCut = entry.second;
-
-        if (stockProfiles.find(profileName) == stockProfiles.end()) {
-            result += QString("No stock available for profile: %1\n").arg(profileName);
-            continue;
-        }
-
-        auto &availableStock = stockProfiles[profileName];
-
-        for (auto &stockLength : availableStock) {
-            bool hasCuts = false;
-            double remainder = stockLength;
-            QString cutsSummary = "";  // Store combined cuts in one line
-
-            for (const auto &lengthAndQuantity : lengthsToCut) {
-                double lengthToCut = lengthAndQuantity.first;
-                int &quantityToCut = const_cast<int &>(lengthAndQuantity.second);  // Allow mutation
-
-                // Cut as many pieces of this length as possible, until remainder is too small
-                while (quantityToCut > 0 && remainder >= lengthToCut) {
-                    remainder -= lengthToCut;
-                    usedStockLength += lengthToCut;  // Track used length
-                    cutsSummary += QString::number(lengthToCut) + " + ";
-                    quantityToCut--;
-                    hasCuts = true;
-                }
-            }
-
-            // If stock was used, calculate the total used length and remainder
-            if (!cutsSummary.isEmpty()) {
-                cutsSummary.chop(3);  // Remove the last " + "
-                QString combinedScheme = QString("%1 from stock profile %2, remainder: %3")
-                                             .arg(cutsSummary)
-                                             .arg(profileName)
-                                             .arg(remainder);
-
-                // Track the cutting scheme and count it
-                auto it = schemeCounts.find(combinedScheme);
-                if (it != schemeCounts.end()) {
-                    schemeCounts[combinedScheme]++;
-                } else {
-                    schemeCounts[combinedScheme] = 1;
-                }
-            }
-
-            // If stock profile was not cut, continue to the next profile
-            if (!hasCuts) {
-                continue;
-            }
-        }
-
-        // Check if any profiles remain uncut
-        for (const auto &lengthAndQuantity : lengthsToCut) {
-            if (lengthAndQuantity.second > 0) {
-                result += QString("Not enough stock for %1 (Need %2 more pieces of length %3)\n")
-                .arg(profileName)
-                    .arg(lengthAndQuantity.second)
-                    .arg(lengthAndQuantity.first);
-            }
-        }
-    }
-
-    // Print grouped cutting schemes with counts
-    for (const auto &scheme : schemeCounts) {
-        if (scheme.second > 1) {
-            result += QString("%1 x (%2)\n").arg(scheme.second).arg(scheme.first);
-        } else {
-            result += scheme.first + "\n";
-        }
-    }
-
-    // **Calculate optimization percentage**: (usedStockLength / totalStockLength) * 100
-    double optimizationPercent = 0.0;
-    if (totalStockLength > 0) {
-        optimizationPercent = (usedStockLength / totalStockLength) * 100;
-    }
-
-    // Display the optimization percentage in the result
-    result += QString("\nOptimization Percentage: %1%\n").arg(optimizationPercent, 0, 'f', 2);
+// Show a cutting plan, either the final one or the best found so far
+void MainWindow::showCuttingResult(const CuttingResult &result) {
+    PhaseTimer timer(&solveStats, "render");
+    resultModel->setResult(result);
 
     // Update the cutting chart with the results
-    chartWidget->setCuttingData(cutData);
-
-    return result;
+    chartWidget->setCuttingResult(result);
 }
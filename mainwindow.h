@@ -2,27 +2,56 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTableWidget>
-#include <QTextEdit>
+#include <QTableView>
+#include <QListView>
 #include <QWidget>
 #include <QMenuBar>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QProgressBar>
+#include <QSpinBox>
+#include <QThread>
+#include <QScrollBar>
+#include <QPixmap>
+#include <QPlainTextEdit>
 
-// Custom Widget to Draw the Full Rectangle Bars for Cutting Scheme
+#include "jobtablemodel.h"
+#include "resultlistmodel.h"
+#include "optimizationworker.h"
+#include "solve_stats.h"
+
+// Custom Widget to Draw the Full Rectangle Bars for Cutting Scheme. One row per
+// distinct scheme with its bar count; only the visible rows are drawn, into a
+// cached pixmap that is rebuilt when the plan, size, scroll position or zoom changes.
 class CuttingChartWidget : public QWidget {
     Q_OBJECT
 
 public:
     explicit CuttingChartWidget(QWidget *parent = nullptr);
-    void setCuttingData(const std::map<QString, std::vector<double>> &data);
+    void setCuttingResult(const CuttingResult &result);
+    void setStats(SolveStats *solveStats) { stats = solveStats; }  // Renders are timed there
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
 
 private:
-    std::map<QString, std::vector<double>> cuttingData; // Holds the cutting scheme data
+    void invalidate();       // Drop the cached chart and schedule a repaint
+    void updateScrollBar();
+    void renderChart();      // Draw the visible rows into the cache
+
+    std::vector<CuttingScheme> schemes;  // Holds the cutting scheme data, one row each
+    std::vector<int> colorIndices;       // Colour of each row, one per profile
+    double longestStock = 0.0;
+    int rowHeight = 24;                  // Zoom level, changed with Ctrl + wheel
+    QScrollBar *scrollBar;
+    QPixmap cache;
+    bool cacheValid = false;
+    SolveStats *stats = nullptr;
 };
 
 // Main Window Class
@@ -34,24 +63,46 @@ public:
     ~MainWindow();
 
 private slots:
-    void optimizeCuts();       // Perform optimization when "Optimize" button is pressed
+    void optimizeCuts();       // Start optimization on a worker thread when "Optimize" button is pressed
+    void cancelOptimization(); // Stop the running optimization, keeping the best plan so far
+    void showCuttingResult(const CuttingResult &result);     // Show a plan in the result area and chart
+    void optimizationFinished(const CuttingResult &result);  // Show the final plan and re-enable the inputs
     void resetTables();        // Reset the input tables
     void addStockRow();        // Add a row to the stock table
     void addProfileRow();      // Add a row to the profile table
     void saveTableData();      // Save table data to file
     void loadTableData();      // Load table data from file
+    void keepOffcuts();        // Book the last plan into the offcut store
+    void exportStats();        // Save the last run's stats as JSON or as a Chrome trace
+    void exportResult();       // Save the plan shown as a report, CSV, JSON, cutting list or binary file
 
 private:
-    QTableWidget *stockTable;
-    QTableWidget *profileTable;
-    QTextEdit *resultArea;
+    QTableView *stockTable;
+    QTableView *profileTable;
+    JobTableModel *stockModel;
+    JobTableModel *profileModel;
+    QListView *resultView;
+    ResultListModel *resultModel;     // The plan shown, made into text a visible line at a time
     CuttingChartWidget *chartWidget;  // Custom widget for displaying cutting chart
     QPushButton *optimizeButton;
+    QComboBox *solverModeBox;         // Which solver the "Optimize" button runs
+    QSpinBox *timeLimitBox;           // Wall-clock budget of one optimization, 0 for none
+    QCheckBox *useOffcutsBox;         // Cut from the offcut store before new stock
+    QPushButton *cancelButton;
+    QProgressBar *progressBar;
+    QPlainTextEdit *statsArea;        // Phase times and counters of the last run
+    QThread *solveThread = nullptr;             // Running optimization, if any
+    OptimizationWorker *solveWorker = nullptr;
+    CuttingResult lastResult;                   // Final plan of the last optimization
+    SolveCache solveCache;                      // Lets the next optimization re-solve only the edited profiles, or
+                                                // carry on from the last session's checkpoint
+    SolveStats solveStats;                      // Of the last optimization, from reading the tables to drawing the plan
 
     void createMenu();  // Function to create the menu
 
-    QString performCuttingOptimization(const std::vector<std::tuple<QString, int, double>> &stockData,
-                                       const std::vector<std::tuple<QString, double, int>> &profileData);
+    CuttingJob readCuttingJob() const;  // Collect the stock and profile tables into a solver job
+    std::string offcutStoreFile() const;  // The offcut store, in the application data directory
+    std::string checkpointFile() const;   // Where solves save their progress, in the same directory
 };
 
 #endif // MAINWINDOW_H
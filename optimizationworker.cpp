@@ -0,0 +1,38 @@
+#include "optimizationworker.h"
+#include "remnant_store.h"
+
+OptimizationWorker::OptimizationWorker(const CuttingJob &job, const SolverOptions &options, const std::string &remnantFile,
+                                       QObject *parent)
+    : QObject(parent), job(job), options(options), remnantFile(remnantFile) {
+    qRegisterMetaType<CuttingResult>();
+}
+
+void OptimizationWorker::cancel() {
+    cancelled = true;
+}
+
+void OptimizationWorker::run() {
+    SolverOptions runOptions = options;
+    runOptions.cancelled = &cancelled;
+
+    // Only signal whole percent steps, the GUI does not need more
+    int lastPercent = -1;
+    runOptions.onProgress = [this, &lastPercent](double fraction) {
+        int percent = static_cast<int>(fraction * 100);
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            emit progressChanged(percent);
+        }
+    };
+    runOptions.onIncumbent = [this](const CuttingResult &result) {
+        emit incumbentFound(result);
+    };
+
+    // A store that cannot be read is left out rather than failing the solve
+    RemnantStore remnants;
+    if (!remnantFile.empty() && remnants.open(remnantFile))
+        runOptions.remnants = &remnants;
+
+    CuttingResult result = solveCuttingJob(job, runOptions);
+    emit finished(result);
+}
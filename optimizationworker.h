@@ -0,0 +1,39 @@
+#ifndef OPTIMIZATIONWORKER_H
+#define OPTIMIZATIONWORKER_H
+
+#include <QObject>
+#include <QMetaType>
+#include <atomic>
+#include <string>
+
+#include "cutting_solver.h"
+
+Q_DECLARE_METATYPE(CuttingResult)
+
+// Runs one solve on a worker thread and reports back through queued signals
+class OptimizationWorker : public QObject {
+    Q_OBJECT
+
+public:
+    // With a remnant file, the offcuts in it are cut first; the file is only read
+    OptimizationWorker(const CuttingJob &job, const SolverOptions &options, const std::string &remnantFile = std::string(),
+                       QObject *parent = nullptr);
+
+    void cancel();  // Safe to call from any thread
+
+public slots:
+    void run();
+
+signals:
+    void progressChanged(int percent);
+    void incumbentFound(const CuttingResult &result);  // A better plan while the solve goes on
+    void finished(const CuttingResult &result);
+
+private:
+    CuttingJob job;
+    SolverOptions options;
+    std::string remnantFile;
+    std::atomic<bool> cancelled{false};
+};
+
+#endif // OPTIMIZATIONWORKER_H
@@ -0,0 +1,48 @@
+#include "resultlistmodel.h"
+
+// Rows: the heading, the shortages, the schemes, then the summary lines
+
+ResultListModel::ResultListModel(QObject *parent) : QAbstractListModel(parent) {
+}
+
+int ResultListModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() || (plan.schemes.empty() && plan.shortages.empty()))
+        return 0;
+    return static_cast<int>(1 + plan.shortages.size() + plan.schemes.size() + summaryLines.size());
+}
+
+QVariant ResultListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    size_t row = index.row();
+    if (row == 0)
+        return QString("Cutting Scheme:");
+    --row;
+    if (row < plan.shortages.size())
+        return QString::fromStdString(formatShortage(plan.shortages[row]));
+    row -= plan.shortages.size();
+    if (row < plan.schemes.size()) {
+        const CuttingScheme &scheme = plan.schemes[row];
+        QString text = QString::fromStdString(formatScheme(scheme));
+        return scheme.count > 1 ? QString("%1 x (%2)").arg(scheme.count).arg(text) : text;
+    }
+    row -= plan.schemes.size();
+    return summaryLines.value(static_cast<int>(row));
+}
+
+void ResultListModel::setResult(const CuttingResult &result) {
+    beginResetModel();
+    plan = result;
+    summaryLines = QString::fromStdString(formatResultSummary(result)).split('\n');
+    if (!summaryLines.isEmpty() && summaryLines.last().isEmpty())
+        summaryLines.removeLast();
+    endResetModel();
+}
+
+void ResultListModel::clear() {
+    beginResetModel();
+    plan = CuttingResult();
+    summaryLines.clear();
+    endResetModel();
+}
@@ -0,0 +1,30 @@
+#ifndef RESULTLISTMODEL_H
+#define RESULTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+#include "cutting_solver.h"
+
+// The report of a plan as a list, one line per row. Only the rows the view
+// shows are ever turned into text, so a plan with tens of thousands of schemes
+// appears at once and takes no more memory than the plan itself.
+class ResultListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit ResultListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setResult(const CuttingResult &result);
+    void clear();
+    const CuttingResult &result() const { return plan; }
+
+private:
+    CuttingResult plan;
+    QStringList summaryLines;  // After the schemes
+};
+
+#endif // RESULTLISTMODEL_H
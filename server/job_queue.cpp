@@ -0,0 +1,107 @@
+#include "job_queue.h"
+#include "remnant_store.h"
+
+#include <algorithm>
+
+JobQueue::JobQueue(unsigned workerCount, const std::string &remnantFile) : remnantFile(remnantFile) {
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < workerCount; ++i)
+        workers.emplace_back(&JobQueue::work, this);
+}
+
+JobQueue::~JobQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+        for (const auto &cancelled : running)
+            *cancelled = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void JobQueue::submit(Request request) {
+    if (!request.cancelled)
+        request.cancelled = std::make_shared<std::atomic<bool>>(false);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.emplace(std::make_pair(-request.priority, arrivals++), std::move(request));
+    }
+    wake.notify_one();
+}
+
+JobQueue::Status JobQueue::status() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {static_cast<unsigned>(workers.size()), queue.size(), running.size(), solved};
+}
+
+// The store as it is on disk now. Jobs still solving keep the one they started with.
+std::shared_ptr<const RemnantStore> JobQueue::currentRemnants() {
+    std::lock_guard<std::mutex> lock(remnantMutex);
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(remnantFile, error);
+    if (error)
+        time = std::filesystem::file_time_type();  // Not there (yet), an empty store
+    if (!remnants || time != remnantTime) {
+        auto store = std::make_shared<RemnantStore>();
+        if (!store->open(remnantFile))
+            return nullptr;
+        remnants = store;
+        remnantTime = time;
+    }
+    return remnants;
+}
+
+void JobQueue::work() {
+    // Kept from job to job. Any thread may take the next job, so an edited job
+    // sent again only keeps the plans of its unchanged profiles when it lands
+    // on the thread that solved it and no other job has run there since.
+    SolveCache cache;
+
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+            request = std::move(queue.begin()->second);
+            queue.erase(queue.begin());
+            running.push_back(request.cancelled);
+        }
+
+        // A job whose client has gone still hears back, so that its connection is cleaned up
+        CuttingJob job;
+        std::string errorMessage = "Cancelled";
+        std::shared_ptr<const RemnantStore> store;
+        bool ok = !*request.cancelled && parseJob(request.jobData.data(), request.jobData.size(), job, &errorMessage);
+        request.jobData.clear();
+        if (ok && request.useOffcuts && !remnantFile.empty()) {
+            store = currentRemnants();
+            if (!store) {
+                ok = false;
+                errorMessage = "Cannot read the offcut store " + remnantFile;
+            }
+        }
+
+        if (ok) {
+            // Jobs run side by side, one thread each
+            SolverOptions options = request.options;
+            options.threads = 1;
+            options.cache = &cache;
+            options.remnants = store.get();
+            options.cancelled = request.cancelled.get();
+            CuttingResult result = solveCuttingJob(job, options);
+            request.done(&result, std::string());
+        } else {
+            request.done(nullptr, errorMessage);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        running.erase(std::find(running.begin(), running.end(), request.cancelled));
+        ++solved;
+    }
+}
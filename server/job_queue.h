@@ -0,0 +1,76 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+// The solving side of the job server: a fixed pool of threads fed from a
+// priority queue. Threads and their solve caches stay up from job to job, and
+// the offcut store stays mapped and is only opened again when its file
+// changes, so a job costs little more than its solve.
+
+#include "cutting_job.h"
+#include "cutting_solver.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class RemnantStore;
+
+class JobQueue {
+public:
+    struct Request {
+        std::string jobData;     // A job file, text or binary, parsed on the solve thread
+        SolverOptions options;   // Cache, offcuts and threads are the queue's business
+        int priority = 0;        // Higher first, equal ones in order of arrival
+        bool useOffcuts = false;
+        std::shared_ptr<std::atomic<bool>> cancelled;  // Set when the client has gone
+        // Called on the solve thread, with the result or else an error message
+        std::function<void(const CuttingResult *result, const std::string &errorMessage)> done;
+    };
+
+    struct Status {
+        unsigned workers;
+        std::size_t queued;
+        std::size_t running;
+        std::uint64_t solved;
+    };
+
+    // With a remnant file, jobs that ask for it cut the offcuts in it first;
+    // the file is only read
+    JobQueue(unsigned workers, const std::string &remnantFile);
+    ~JobQueue();  // Cancels the running jobs and drops the queued ones
+    JobQueue(const JobQueue &) = delete;
+    JobQueue &operator=(const JobQueue &) = delete;
+
+    void submit(Request request);
+    Status status() const;
+
+private:
+    void work();
+    std::shared_ptr<const RemnantStore> currentRemnants();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::map<std::pair<int, std::uint64_t>, Request> queue;  // Keyed by minus priority, then arrival
+    std::uint64_t arrivals = 0;
+    std::vector<std::shared_ptr<std::atomic<bool>>> running;
+    std::uint64_t solved = 0;
+    bool stopping = false;
+
+    std::mutex remnantMutex;
+    std::string remnantFile;
+    std::shared_ptr<const RemnantStore> remnants;
+    std::filesystem::file_time_type remnantTime;
+
+    std::vector<std::thread> workers;
+};
+
+#endif // JOB_QUEUE_H
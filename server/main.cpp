@@ -0,0 +1,421 @@
+// Job server: keeps a pool of solve threads running and takes cutting jobs over
+// a local socket (a UNIX domain socket, a named pipe on Windows), so that other
+// programs get plans without starting the GUI or a process per job. The same
+// program is also a client for trying it out.
+//
+// One request per connection. The client sends
+//     solve [priority=<n>] [mode=greedy|bfd|cg|lns] [format=text|csv|json|cutlist]
+//           [time=<seconds>] [seed=<n>] [offcuts=1] size=<bytes>\n<job file, text or binary>
+// or
+//     status\n
+// and the server answers "ok\n" followed by the result, streamed as it is
+// written, or "error <message>\n", and closes the connection. A client that
+// disconnects early cancels its job.
+
+#include "cutting_job.h"
+#include "cutting_solver.h"
+#include "job_queue.h"
+#include "result_writer.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+static const char *defaultServerName = "cuttingoptimizer";
+static const int maxHeaderLength = 1024;
+static const long long maxJobBytes = 1LL << 30;  // The job is held in memory while it is read
+static const long long maxJobReserve = 1LL << 20;  // Reserved before any of the job has arrived
+static const long long maxPendingResult = 1LL << 20;  // Result bytes queued for a slow client
+
+static void printUsage(const char *program) {
+    std::cerr << "Usage: " << program << " [--name <server>] [-j <workers>] [-r <offcut-file>]\n"
+              << "       " << program << " --submit <job-file> [--name <server>] [-p <priority>] [-m greedy|bfd|cg|lns]\n"
+              << "              [-f text|csv|json|cutlist] [-t <seconds>] [-s <seed>] [--use-offcuts]\n"
+              << "       " << program << " --status [--name <server>]\n"
+              << "Runs the job server, default name " << defaultServerName << ", with one solve thread per core\n"
+              << "unless -j says otherwise. Jobs larger than " << (maxJobBytes >> 20) << " MiB are refused.\n"
+              << "-r lets jobs sent with --use-offcuts cut the offcuts in <offcut-file> first. The server only reads\n"
+              << "the file, and picks up changes the GUI or the batch tool make to it.\n"
+              << "--submit sends a job to a running server and prints the result; higher priorities go first.\n";
+}
+
+// Result bytes a solve thread has handed to a socket and the socket has not
+// yet written, so that a client that reads slowly holds up its solve thread
+// instead of having the whole plan queued for it
+struct ResultBacklog {
+    std::mutex mutex;
+    std::condition_variable drained;
+    long long bytes = 0;
+    bool closed = false;  // Nothing more will be written
+
+    void release(long long written) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bytes -= written;
+        }
+        drained.notify_all();
+    }
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        drained.notify_all();
+    }
+};
+
+// What a solve line asks for, see the top of the file
+struct SolveRequest {
+    JobQueue::Request queued;
+    ResultFormat format = ResultFormat::Report;
+    long long size = -1;
+};
+
+// Whole numbers only: atoi and atof take "12abc" as 12 and "abc" as 0
+static bool parseInteger(const std::string &text, long long low, long long high, long long &value) {
+    if (text.empty() || std::isspace(static_cast<unsigned char>(text[0])))
+        return false;
+    char *end = nullptr;
+    errno = 0;
+    const long long parsed = std::strtoll(text.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0' || parsed < low || parsed > high)
+        return false;
+    value = parsed;
+    return true;
+}
+
+static bool parseSeed(const std::string &text, std::uint64_t &value) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])))
+        return false;
+    char *end = nullptr;
+    errno = 0;
+    const unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0')
+        return false;
+    value = parsed;
+    return true;
+}
+
+static bool parseSeconds(const std::string &text, double &value) {
+    if (text.empty() || std::isspace(static_cast<unsigned char>(text[0])))
+        return false;
+    char *end = nullptr;
+    errno = 0;
+    const double parsed = std::strtod(text.c_str(), &end);
+    if (errno != 0 || *end != '\0' || !std::isfinite(parsed) || parsed < 0)
+        return false;
+    value = parsed;
+    return true;
+}
+
+static bool parseSolveLine(const std::string &line, SolveRequest &request, std::string *errorMessage) {
+    std::istringstream words(line);
+    std::string word;
+    words >> word;  // "solve"
+    while (words >> word) {
+        const std::size_t equals = word.find('=');
+        const std::string key = word.substr(0, equals);
+        const std::string value = equals == std::string::npos ? std::string() : word.substr(equals + 1);
+        bool ok = !value.empty();
+        long long number = 0;
+        if (key == "priority") {
+            ok = parseInteger(value, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), number);
+            request.queued.priority = static_cast<int>(number);
+        } else if (key == "mode") {
+            ok = parseSolverMode(value, request.queued.options.mode);
+        } else if (key == "format") {
+            ok = parseResultFormat(value, request.format) && request.format != ResultFormat::Binary;
+        } else if (key == "time") {
+            ok = parseSeconds(value, request.queued.options.timeLimit);
+        } else if (key == "seed") {
+            ok = parseSeed(value, request.queued.options.seed);
+        } else if (key == "offcuts") {
+            ok = value == "0" || value == "1";
+            request.queued.useOffcuts = value == "1";
+        } else if (key == "size") {
+            ok = parseInteger(value, 0, std::numeric_limits<long long>::max(), request.size);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            if (errorMessage)
+                *errorMessage = "Bad request field: " + word;
+            return false;
+        }
+    }
+    if (request.size < 0) {
+        if (errorMessage)
+            *errorMessage = "Request without size";
+        return false;
+    }
+    if (request.size > maxJobBytes) {
+        if (errorMessage)
+            *errorMessage = "Job too large, at most " + std::to_string(maxJobBytes) + " bytes";
+        return false;
+    }
+    return true;
+}
+
+static void sendError(QLocalSocket *socket, const std::string &message) {
+    socket->write(QByteArray::fromStdString("error " + message + "\n"));
+    socket->disconnectFromServer();
+}
+
+// Runs on a solve thread: the result goes to the socket's thread a chunk at a
+// time, so a big plan is never held as a whole. Once maxPendingResult bytes
+// are waiting to be written, the next chunk waits for the client to catch up.
+static void sendResult(QLocalSocket *socket, const std::shared_ptr<ResultBacklog> &backlog, ResultFormat format,
+                       const CuttingResult *result, const std::string &errorMessage) {
+    auto post = [socket, &backlog](QByteArray chunk) {
+        {
+            std::unique_lock<std::mutex> lock(backlog->mutex);
+            backlog->drained.wait(lock, [&] { return backlog->closed || backlog->bytes < maxPendingResult; });
+            if (backlog->closed)
+                return;
+            backlog->bytes += chunk.size();
+        }
+        QMetaObject::invokeMethod(socket, [socket, backlog, chunk]() {
+            if (socket->state() != QLocalSocket::ConnectedState || socket->write(chunk) < 0)
+                backlog->release(chunk.size());
+        }, Qt::QueuedConnection);
+    };
+
+    if (result) {
+        post("ok\n");
+        auto output = [&post](const char *data, std::size_t size) { post(QByteArray(data, static_cast<int>(size))); };
+        if (format == ResultFormat::Csv) {
+            CsvSink sink(output);
+            writeCuttingResult(*result, sink);
+        } else if (format == ResultFormat::Json) {
+            JsonSink sink(output);
+            writeCuttingResult(*result, sink);
+        } else if (format == ResultFormat::CuttingList) {
+            CuttingListSink sink(output);
+            writeCuttingResult(*result, sink);
+        } else {
+            post("Cutting Scheme:\n");
+            ReportSink sink(output);
+            writeCuttingResult(*result, sink);
+        }
+    }
+
+    // Last, once everything before it has been written. The socket is only
+    // deleted after this has run.
+    QMetaObject::invokeMethod(socket, [socket, failed = !result, errorMessage]() {
+        socket->setProperty("solving", false);
+        if (socket->state() != QLocalSocket::ConnectedState)
+            socket->deleteLater();
+        else if (failed)
+            sendError(socket, errorMessage);
+        else
+            socket->disconnectFromServer();
+    }, Qt::QueuedConnection);
+}
+
+static void serveConnection(QLocalSocket *socket, JobQueue &queue) {
+    auto request = std::make_shared<SolveRequest>();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    auto backlog = std::make_shared<ResultBacklog>();
+
+    QObject::connect(socket, &QLocalSocket::bytesWritten, socket, [backlog](qint64 written) {
+        backlog->release(written);
+    });
+    QObject::connect(socket, &QLocalSocket::disconnected, socket, [socket, cancelled, backlog]() {
+        *cancelled = true;
+        backlog->close();
+        if (!socket->property("solving").toBool())
+            socket->deleteLater();
+    });
+    // No event loop is left to write what a solve thread still sends
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, socket, [backlog]() {
+        backlog->close();
+    });
+
+    QObject::connect(socket, &QLocalSocket::readyRead, socket, [socket, request, cancelled, backlog, &queue]() {
+        if (request->size < 0) {
+            if (!socket->canReadLine()) {
+                if (socket->bytesAvailable() > maxHeaderLength)
+                    sendError(socket, "Request line too long");
+                return;
+            }
+            const std::string line = socket->readLine().trimmed().toStdString();
+            if (line == "status") {
+                const JobQueue::Status status = queue.status();
+                socket->write(QByteArray::fromStdString(
+                    "ok\nworkers " + std::to_string(status.workers) + "\nqueued " + std::to_string(status.queued)
+                    + "\nrunning " + std::to_string(status.running) + "\nsolved " + std::to_string(status.solved) + "\n"));
+                socket->disconnectFromServer();
+                return;
+            }
+            std::string errorMessage;
+            if (line.compare(0, 5, "solve") != 0 || !parseSolveLine(line, *request, &errorMessage)) {
+                sendError(socket, errorMessage.empty() ? "Unknown request: " + line : errorMessage);
+                return;
+            }
+            // A client may announce more than it sends; beyond this the
+            // buffer grows as the job arrives
+            request->queued.jobData.reserve(static_cast<std::size_t>(std::min(request->size, maxJobReserve)));
+        }
+
+        const QByteArray data = socket->read(request->size - static_cast<long long>(request->queued.jobData.size()));
+        request->queued.jobData.append(data.constData(), static_cast<std::size_t>(data.size()));
+        if (static_cast<long long>(request->queued.jobData.size()) < request->size)
+            return;
+
+        // The whole job is in; nothing more is read from this connection
+        QObject::disconnect(socket, &QLocalSocket::readyRead, nullptr, nullptr);
+        socket->setProperty("solving", true);
+        JobQueue::Request queued = std::move(request->queued);
+        const ResultFormat format = request->format;
+        queued.cancelled = cancelled;
+        queued.done = [socket, backlog, format](const CuttingResult *result, const std::string &errorMessage) {
+            sendResult(socket, backlog, format, result, errorMessage);
+        };
+        queue.submit(std::move(queued));
+    });
+}
+
+static int runServer(const QString &name, unsigned workers, const std::string &remnantFile) {
+    // Declared first so that the solve threads are gone before the sockets they write to
+    QLocalServer server;
+    JobQueue queue(workers, remnantFile);
+
+    // A server that crashed leaves its socket file behind; one that still
+    // answers keeps its name
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(1000)) {
+        std::cerr << "A server named " << name.toStdString() << " is already running\n";
+        return 1;
+    }
+    QLocalServer::removeServer(name);
+
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!server.listen(name)) {
+        std::cerr << "Cannot listen on " << name.toStdString() << ": " << server.errorString().toStdString() << "\n";
+        return 1;
+    }
+    QObject::connect(&server, &QLocalServer::newConnection, &server, [&server, &queue]() {
+        while (QLocalSocket *socket = server.nextPendingConnection())
+            serveConnection(socket, queue);
+    });
+
+    std::cout << "Serving " << server.fullServerName().toStdString() << " with " << queue.status().workers
+              << " solve threads\n" << std::flush;
+    return QCoreApplication::exec();
+}
+
+// Send one request and copy the answer to stdout; errors go to stderr
+static int runClient(const QString &name, const std::string &request) {
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (!socket.waitForConnected(5000)) {
+        std::cerr << "Cannot connect to " << name.toStdString() << ": " << socket.errorString().toStdString() << "\n";
+        return 1;
+    }
+    socket.write(request.data(), static_cast<qint64>(request.size()));
+
+    QByteArray answer;
+    bool statusRead = false;
+    while (socket.waitForReadyRead(-1) || socket.bytesAvailable() > 0) {
+        answer += socket.readAll();
+        if (!statusRead) {
+            const int newline = answer.indexOf('\n');
+            if (newline < 0)
+                continue;
+            if (!answer.startsWith("ok")) {
+                std::cerr << answer.constData();
+                return 1;
+            }
+            answer.remove(0, newline + 1);
+            statusRead = true;
+        }
+        std::fwrite(answer.constData(), 1, static_cast<std::size_t>(answer.size()), stdout);
+        answer.clear();
+    }
+    if (!statusRead) {
+        std::cerr << "The server closed the connection without an answer\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QString name = defaultServerName;
+    unsigned workers = 0;
+    std::string remnantFile;
+    std::string jobFile;
+    bool status = false;
+    std::string solveLine = "solve";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--name" && i + 1 < argc) {
+            name = QString::fromLocal8Bit(argv[++i]);
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            workers = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if ((arg == "-r" || arg == "--offcuts") && i + 1 < argc) {
+            remnantFile = argv[++i];
+        } else if (arg == "--submit" && i + 1 < argc) {
+            jobFile = argv[++i];
+        } else if (arg == "--status") {
+            status = true;
+        } else if ((arg == "-p" || arg == "--priority") && i + 1 < argc) {
+            solveLine += std::string(" priority=") + argv[++i];
+        } else if ((arg == "-m" || arg == "--mode") && i + 1 < argc) {
+            solveLine += std::string(" mode=") + argv[++i];
+        } else if ((arg == "-f" || arg == "--format") && i + 1 < argc) {
+            solveLine += std::string(" format=") + argv[++i];
+        } else if ((arg == "-t" || arg == "--time-limit") && i + 1 < argc) {
+            solveLine += std::string(" time=") + argv[++i];
+        } else if ((arg == "-s" || arg == "--seed") && i + 1 < argc) {
+            solveLine += std::string(" seed=") + argv[++i];
+        } else if (arg == "--use-offcuts") {
+            solveLine += " offcuts=1";
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (status)
+        return runClient(name, "status\n");
+    if (!jobFile.empty()) {
+        std::ifstream file(jobFile, std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot open file: " << jobFile << "\n";
+            return 2;
+        }
+        const std::string job((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return runClient(name, solveLine + " size=" + std::to_string(job.size()) + "\n" + job);
+    }
+    if (solveLine != "solve") {
+        printUsage(argv[0]);
+        return 2;
+    }
+    return runServer(name, workers, remnantFile);
+}
@@ -0,0 +1,24 @@
+# Job server: cuttingserver [--name <server>] [-j <workers>] [-r <offcut-file>]
+# Client for trying it out: cuttingserver --submit <job-file> [-p <priority>] [-m greedy|bfd|cg|lns] [-f text|csv|json|cutlist]
+
+TEMPLATE = app
+TARGET = cuttingserver
+QT = core network
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+include(../solver/solver.pri)
+
+unix: LIBS += -pthread
+
+SOURCES += \
+    job_queue.cpp \
+    main.cpp
+
+HEADERS += \
+    job_queue.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
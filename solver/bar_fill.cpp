@@ -0,0 +1,181 @@
+#include "bar_fill.h"
+
+#include <algorithm>
+#include <numeric>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BAR_FILL_AVX2
+#endif
+
+namespace {
+
+// added = (bits << shift) & ~bits, then bits |= added, over `words` words.
+// Reading and writing different arrays keeps both loops free of dependencies.
+// GCC leaves them scalar at -O2, so x86 builds also carry an AVX2 copy and pick
+// it at run time on processors that have it.
+void shiftOrPortable(std::uint64_t *bits, std::size_t words, std::size_t wordShift, unsigned bitShift,
+                     std::uint64_t *added) {
+    const std::uint64_t *source = bits;
+    if (bitShift == 0) {
+        for (std::size_t w = wordShift; w < words; ++w)
+            added[w] = source[w - wordShift] & ~source[w];
+    } else {
+        added[wordShift] = (source[0] << bitShift) & ~source[wordShift];
+        for (std::size_t w = wordShift + 1; w < words; ++w)
+            added[w] = (source[w - wordShift] << bitShift | source[w - wordShift - 1] >> (64 - bitShift)) & ~source[w];
+    }
+    for (std::size_t w = wordShift; w < words; ++w)
+        bits[w] |= added[w];
+}
+
+#ifdef BAR_FILL_AVX2
+// The same four words at a time. A vector shift by 64 gives 0, so a whole word
+// shift needs no case of its own.
+__attribute__((target("avx2")))
+void shiftOrAvx2(std::uint64_t *bits, std::size_t words, std::size_t wordShift, unsigned bitShift,
+                 std::uint64_t *added) {
+    const std::uint64_t *source = bits;
+    const __m128i left = _mm_cvtsi32_si128(static_cast<int>(bitShift));
+    const __m128i right = _mm_cvtsi32_si128(static_cast<int>(64 - bitShift));
+    added[wordShift] = (source[0] << bitShift) & ~source[wordShift];
+    std::size_t w = wordShift + 1;
+    for (; w + 4 <= words; w += 4) {
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + w - wordShift));
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + w - wordShift - 1));
+        const __m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + w));
+        const __m256i shifted = _mm256_or_si256(_mm256_sll_epi64(high, left), _mm256_srl_epi64(low, right));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(added + w), _mm256_andnot_si256(old, shifted));
+    }
+    for (; w < words; ++w) {
+        const std::uint64_t carry = bitShift == 0 ? 0 : source[w - wordShift - 1] >> (64 - bitShift);
+        added[w] = (source[w - wordShift] << bitShift | carry) & ~source[w];
+    }
+
+    w = wordShift;
+    for (; w + 4 <= words; w += 4) {
+        __m256i *target = reinterpret_cast<__m256i *>(bits + w);
+        const __m256i more = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added + w));
+        _mm256_storeu_si256(target, _mm256_or_si256(_mm256_loadu_si256(target), more));
+    }
+    for (; w < words; ++w)
+        bits[w] |= added[w];
+}
+#endif
+
+int lowestBit(std::uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while (!(bits >> bit & 1))
+        ++bit;
+    return bit;
+#endif
+}
+
+} // namespace
+
+void shiftReachable(std::uint64_t *bits, std::size_t words, std::size_t shift, std::uint64_t *added, bool portable) {
+    const std::size_t wordShift = std::min(shift / 64, words);
+    const unsigned bitShift = static_cast<unsigned>(shift % 64);
+    std::fill(added, added + wordShift, 0);
+    if (wordShift == words)
+        return;
+#ifdef BAR_FILL_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2 && !portable) {
+        shiftOrAvx2(bits, words, wordShift, bitShift, added);
+        return;
+    }
+#else
+    (void)portable;
+#endif
+    shiftOrPortable(bits, words, wordShift, bitShift, added);
+}
+
+BarFiller::BarFiller(const std::vector<Length> &lengths, const std::vector<Length> &barLengths)
+    : lengths(lengths), step(gridStep(lengths, barLengths)) {
+}
+
+Length BarFiller::gridStep(const std::vector<Length> &lengths, const std::vector<Length> &barLengths) {
+    Length gcd = 0;
+    Length longestBar = 0;
+    for (Length length : lengths)
+        gcd = std::gcd(gcd, length);
+    for (Length length : barLengths) {
+        gcd = std::gcd(gcd, length);
+        longestBar = std::max(longestBar, length);
+    }
+    Length step = std::max<Length>(gcd, 1);
+    const Length cells = longestBar / step;
+    if (cells > maxCells)
+        step *= (cells + maxCells - 1) / maxCells;
+    return step;
+}
+
+Length BarFiller::fill(const std::vector<int> &limits, Length capacity, std::vector<int> &counts) {
+    counts.assign(lengths.size(), 0);
+    const Length maxCell = capacity / step;
+    const std::size_t words = static_cast<std::size_t>(maxCell) / 64 + 1;
+
+    // Bounded counts by binary splitting into 0-1 chunks, longest first: a
+    // length is first reached with the longest pieces that can reach it
+    chunks.clear();
+    Length used = 0;
+    for (std::size_t i = 0; i < lengths.size(); ++i) {
+        const Length cells = (lengths[i] + step - 1) / step;
+        if (limits[i] <= 0 || cells > maxCell)
+            continue;
+        if (cells <= 0) {
+            // Pieces of no length always fit
+            counts[i] = limits[i];
+            used += lengths[i] * limits[i];
+            continue;
+        }
+        int limit = static_cast<int>(std::min<Length>(limits[i], maxCell / cells));
+        for (int multiplicity = 1; limit > 0; multiplicity *= 2) {
+            int take = std::min(multiplicity, limit);
+            chunks.push_back({static_cast<int>(i), take});
+            limit -= take;
+        }
+    }
+
+    reachable.assign(words, 0);
+    reachable[0] = 1;
+    reachedBy.resize(static_cast<std::size_t>(maxCell) + 1);
+    std::vector<std::uint64_t> added(words);
+    const std::uint64_t lastWordMask = ~std::uint64_t(0) >> (63 - static_cast<unsigned>(maxCell % 64));
+
+    Length top = 0;  // No length above this is reachable yet
+    for (std::size_t j = 0; j < chunks.size(); ++j) {
+        const Length cells = (lengths[chunks[j].item] + step - 1) / step * chunks[j].multiplicity;
+        if (cells > maxCell)
+            continue;
+        top = std::min(top + cells, maxCell);
+        const std::size_t activeWords = static_cast<std::size_t>(top) / 64 + 1;
+        shiftReachable(reachable.data(), activeWords, static_cast<std::size_t>(cells), added.data());
+        added[words - 1] &= lastWordMask;
+        reachable[words - 1] &= lastWordMask;
+        for (std::size_t w = 0; w < activeWords; ++w) {
+            for (std::uint64_t bits = added[w]; bits != 0; bits &= bits - 1)
+                reachedBy[w * 64 + static_cast<std::size_t>(lowestBit(bits))] = static_cast<std::uint32_t>(j);
+        }
+        if (reachable[words - 1] >> (maxCell % 64) & 1)
+            break;  // The bar can be filled to the last cell
+    }
+
+    // The fullest length reached, then back through the chunks that reached it.
+    // A chunk that first reached c did so from a length reached by earlier
+    // chunks only, so no chunk is taken twice.
+    std::size_t cell = static_cast<std::size_t>(maxCell);
+    while (!(reachable[cell / 64] >> (cell % 64) & 1))
+        --cell;
+    while (cell > 0) {
+        const Chunk &chunk = chunks[reachedBy[cell]];
+        counts[chunk.item] += chunk.multiplicity;
+        used += lengths[chunk.item] * chunk.multiplicity;
+        cell -= static_cast<std::size_t>((lengths[chunk.item] + step - 1) / step * chunk.multiplicity);
+    }
+    return used;
+}
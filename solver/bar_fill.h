@@ -0,0 +1,53 @@
+#ifndef BAR_FILL_H
+#define BAR_FILL_H
+
+// Internal to the solver: the fullest fill of one bar, exactly. A bounded
+// subset sum over the piece lengths, kept as a bitset of reachable lengths that
+// every piece shifts and ORs into itself 64 cells at a time; which piece first
+// reached each length is noted, so the fill can be read back. A 12 m bar at
+// 1 mm takes a few microseconds per distinct length.
+
+#include "length.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BarFiller {
+public:
+    // Bars longer than this many grid cells are filled on a coarser grid, with
+    // lengths rounded up; the fill then still fits but may not be the fullest
+    static const Length maxCells = Length(1) << 20;
+
+    // `lengths` are the distinct piece lengths, longest first. The grid is
+    // their greatest common divisor with every bar length to be filled.
+    BarFiller(const std::vector<Length> &lengths, const std::vector<Length> &barLengths);
+    static Length gridStep(const std::vector<Length> &lengths, const std::vector<Length> &barLengths);
+
+    // Pieces of each length to cut from a bar of `capacity`, at most limits[i]
+    // of length i, using as much of the bar as possible. Returns the length used.
+    // Among equally full fills it prefers the one with longer pieces.
+    Length fill(const std::vector<int> &limits, Length capacity, std::vector<int> &counts);
+
+private:
+    struct Chunk {
+        int item;
+        int multiplicity;
+    };
+
+    std::vector<Length> lengths;
+    Length step = 1;
+    std::vector<Chunk> chunks;
+    std::vector<std::uint64_t> reachable;  // Bit c: c grid cells can be filled exactly
+    std::vector<std::uint32_t> reachedBy;  // Chunk that first reached each cell
+};
+
+// The step of fill() for each chunk of pieces: every cell set in `bits` also
+// sets the cell `shift` further on. The cells this newly sets are put in
+// `added`. x86 builds with GCC or Clang do it four words at a time on
+// processors with AVX2, unless `portable` asks for the plain loop, so that
+// tests can compare the two.
+void shiftReachable(std::uint64_t *bits, std::size_t words, std::size_t shift, std::uint64_t *added,
+                    bool portable = false);
+
+#endif // BAR_FILL_H
@@ -0,0 +1,153 @@
+// Best fit decreasing: every piece, longest first, goes into the open bar with
+// the least room that still takes it. Open bars are indexed by their room on a
+// grid of whole length steps, so finding that bar is a successor query in a
+// small hierarchical bitmap instead of a scan over the bars.
+
+#include "profile_group.h"
+#include "room_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+struct OpenBar {
+    std::size_t stockClass;
+    Length room;
+    CutPattern cuts;
+};
+
+// One pass, opening the longest bar left or, when `cheapest`, the one that
+// costs least for what it can be filled with, the longer on a tie. Returns the
+// cost of the bars cut.
+Length bestFit(ProfileGroup &group, std::vector<GroupScheme> &schemes, bool cheapest) {
+    // Every room is a whole number of steps of the common divisor of all lengths.
+    // Very fine grids are coarsened; rooms then round down into their cell, so a
+    // bar found is always long enough, if not always the tightest.
+    const std::size_t maxCells = std::size_t(1) << 20;
+    Length step = 0;
+    for (Length length : group.pieceLengths)
+        step = std::gcd(step, length);
+    for (const auto &stock : group.stock)
+        step = std::gcd(step, stock.length);
+    step = std::max<Length>(step, 1);
+    const Length longestStock = group.stock.front().length;
+    if (longestStock / step >= static_cast<Length>(maxCells))
+        step *= longestStock / step / maxCells + 1;
+
+    RoomIndex index(static_cast<std::size_t>(longestStock / step) + 1);
+    std::vector<OpenBar> bars;
+
+    // Pieces go longest first, so every shorter length is still there to fill a room
+    Length shortest = longestStock;
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        if (lengthAndQuantity.second > 0 && lengthAndQuantity.first > 0)
+            shortest = std::min(shortest, lengthAndQuantity.first);
+    }
+
+    for (auto &lengthAndQuantity : group.lengthsToCut) {
+        const Length length = lengthAndQuantity.first;
+        const CutPattern::Index piece = pieceIndex(group, length);
+        if (length < 0 || length > longestStock)
+            continue;
+        const std::size_t wanted = static_cast<std::size_t>((length + step - 1) / step);
+
+        for (; lengthAndQuantity.second > 0; --lengthAndQuantity.second) {
+            std::size_t cell = index.next(wanted);
+            std::uint32_t b;
+            if (cell != RoomIndex::none) {
+                b = index.pop(cell);
+            } else {
+                // A new bar; each is cut down to size at the end. Its cost is
+                // spread over what it can be filled with: copies of this piece,
+                // then shorter ones unless the room left is too short for any.
+                auto stock = group.stock.end();
+                Length stockFill = 0;
+                for (auto it = group.stock.begin(); it != group.stock.end(); ++it) {
+                    if (it->available <= 0 || it->length < length)
+                        continue;
+                    const Length copies = length > 0 ? std::min<Length>(it->length / length, lengthAndQuantity.second) : 0;
+                    const Length room = it->length - copies * length;
+                    const Length fill = room >= shortest ? it->length : it->length - room;
+                    if (stock == group.stock.end() || it->cost * stockFill < stock->cost * fill) {
+                        stock = it;
+                        stockFill = fill;
+                    }
+                    if (!cheapest)
+                        break;
+                }
+                if (stock == group.stock.end())
+                    break;
+                --stock->available;
+                b = static_cast<std::uint32_t>(bars.size());
+                bars.push_back({static_cast<std::size_t>(stock - group.stock.begin()), stock->length, CutPattern()});
+            }
+
+            OpenBar &bar = bars[b];
+            bar.cuts.push_back(piece);
+            bar.room -= length;
+            index.push(static_cast<std::size_t>(bar.room / step), b);
+        }
+    }
+
+    // Move each bar's cuts to the cheapest bar left that holds them, the
+    // shortest on a tie, and count identical bars as one scheme
+    SchemeCounter counter;
+    Length cost = 0;
+    for (OpenBar &bar : bars) {
+        const Length used = group.stock[bar.stockClass].length - bar.room;
+        std::size_t cheapest = bar.stockClass;
+        for (std::size_t k = group.stock.size(); k-- > 0;) {
+            if (group.stock[k].available > 0 && group.stock[k].length >= used
+                && group.stock[k].cost < group.stock[cheapest].cost)
+                cheapest = k;
+        }
+        if (cheapest != bar.stockClass) {
+            ++group.stock[bar.stockClass].available;
+            --group.stock[cheapest].available;
+            bar.stockClass = cheapest;
+        }
+        const Length stockLength = group.stock[bar.stockClass].length;
+        counter.add({stockLength, bar.cuts, stockLength - used, 1});
+        cost += group.stock[bar.stockClass].cost;
+    }
+    schemes.insert(schemes.end(), counter.schemes().begin(), counter.schemes().end());
+    return cost;
+}
+
+long long missingPieces(const ProfileGroup &group) {
+    long long missing = 0;
+    for (const auto &lengthAndQuantity : group.lengthsToCut)
+        missing += std::max(lengthAndQuantity.second, 0);
+    return missing;
+}
+
+} // namespace
+
+void solveGroupBestFit(ProfileGroup &group, std::vector<GroupScheme> &schemes) {
+    if (group.stock.empty())
+        return;
+
+    // Where some length costs less per length than the longest, also the pass
+    // that opens those first. It can leave long pieces badly packed, so it
+    // has to win outright.
+    const StockClass &longest = group.stock.front();
+    const bool byCost = std::any_of(group.stock.begin(), group.stock.end(), [&](const StockClass &stock) {
+        return stock.cost * longest.length < longest.cost * stock.length;
+    });
+    ProfileGroup cheap = byCost ? group : ProfileGroup();
+
+    std::vector<GroupScheme> longestSchemes;
+    const Length cost = bestFit(group, longestSchemes, false);
+    if (byCost) {
+        std::vector<GroupScheme> cheapSchemes;
+        const Length cheapCost = bestFit(cheap, cheapSchemes, true);
+        if (std::make_pair(missingPieces(cheap), cheapCost) < std::make_pair(missingPieces(group), cost)) {
+            group = std::move(cheap);
+            longestSchemes = std::move(cheapSchemes);
+        }
+    }
+    schemes.insert(schemes.end(), longestSchemes.begin(), longestSchemes.end());
+}
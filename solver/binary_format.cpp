@@ -0,0 +1,460 @@
+#include "binary_format.h"
+#include "solve_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+const char jobMagic[6] = {'C', 'U', 'T', 'J', 'O', 'B'};
+const char resultMagic[6] = {'C', 'U', 'T', 'R', 'E', 'S'};
+const char checkpointMagic[6] = {'C', 'U', 'T', 'C', 'K', 'P'};
+const std::uint16_t formatVersion = 4;
+const std::uint16_t oldestReadableVersion = 1;  // Version 1 results have no stock lower bound, 2 no offcut flag
+const std::uint16_t firstPricedVersion = 4;     // Bar prices and stock cost
+const std::uint16_t firstCheckpointVersion = 3;
+
+bool hasMagic(const char *data, std::size_t size, const char (&magic)[6]) {
+    return size >= sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+bool readHeader(Reader &reader, const char (&magic)[6], const char *kind,
+                std::vector<std::string> &names, std::string *errorMessage, std::uint16_t *fileVersion = nullptr) {
+    std::uint16_t version = 0;
+    if (!reader.getHeader(magic, version, names)) {
+        if (errorMessage)
+            *errorMessage = std::string("Not a valid binary ") + kind + " file";
+        return false;
+    }
+    if (version < oldestReadableVersion || version > formatVersion) {
+        if (errorMessage)
+            *errorMessage = std::string("Unsupported binary ") + kind + " file version " + std::to_string(version);
+        return false;
+    }
+    if (fileVersion)
+        *fileVersion = version;
+    return true;
+}
+
+bool corrupt(const char *kind, std::string *errorMessage) {
+    if (errorMessage)
+        *errorMessage = std::string("Binary ") + kind + " file is truncated or corrupt";
+    return false;
+}
+
+void putScheme(Writer &writer, const GroupScheme &scheme) {
+    writer.put(scheme.stockLength);
+    writer.put(scheme.remainder);
+    writer.put(static_cast<std::int32_t>(scheme.count));
+    writer.put(static_cast<std::uint32_t>(scheme.cuts.size()));
+    for (CutPattern::Index cut : scheme.cuts)
+        writer.put(cut);
+}
+
+void putSchemes(Writer &writer, const std::vector<GroupScheme> &schemes) {
+    writer.put(static_cast<std::uint32_t>(schemes.size()));
+    for (const auto &scheme : schemes)
+        putScheme(writer, scheme);
+}
+
+void putLengths(Writer &writer, const std::vector<std::pair<Length, int>> &lengths) {
+    writer.put(static_cast<std::uint32_t>(lengths.size()));
+    for (const auto &lengthAndQuantity : lengths) {
+        writer.put(lengthAndQuantity.first);
+        writer.put(static_cast<std::int32_t>(lengthAndQuantity.second));
+    }
+}
+
+void putLengths(Writer &writer, const std::vector<Length> &lengths) {
+    writer.put(static_cast<std::uint32_t>(lengths.size()));
+    for (Length length : lengths)
+        writer.put(length);
+}
+
+// Checkpoint schemes are used as they are, so every cut has to index one of the
+// group's piece lengths and every bar be of one of its stock lengths
+bool getSchemes(Reader &reader, const SolveCache::State::Group &group, std::vector<GroupScheme> &schemes) {
+    const std::size_t schemeSize = 2 * sizeof(Length) + sizeof(std::int32_t) + sizeof(std::uint32_t);
+    std::uint32_t count;
+    if (!reader.getCount(count, schemeSize))
+        return false;
+    schemes.resize(count);
+    for (auto &scheme : schemes) {
+        std::int32_t bars;
+        std::uint32_t cuts;
+        if (!reader.get(scheme.stockLength) || !reader.get(scheme.remainder) || !reader.get(bars) || bars < 0
+            || !reader.getCount(cuts, sizeof(CutPattern::Index)))
+            return false;
+        scheme.count = bars;
+        scheme.cuts = CutPattern();
+        for (std::uint32_t c = 0; c < cuts; ++c) {
+            CutPattern::Index cut;
+            if (!reader.get(cut) || cut >= group.pieceLengths.size())
+                return false;
+            scheme.cuts.push_back(cut);
+        }
+        if (std::none_of(group.stock.begin(), group.stock.end(),
+                         [&](const StockClass &stock) { return stock.length == scheme.stockLength; }))
+            return false;
+    }
+    return true;
+}
+
+bool getLengths(Reader &reader, std::vector<std::pair<Length, int>> &lengths) {
+    std::uint32_t count;
+    if (!reader.getCount(count, sizeof(Length) + sizeof(std::int32_t)))
+        return false;
+    lengths.resize(count);
+    for (auto &lengthAndQuantity : lengths) {
+        std::int32_t quantity;
+        if (!reader.get(lengthAndQuantity.first) || !reader.get(quantity))
+            return false;
+        lengthAndQuantity.second = quantity;
+    }
+    return true;
+}
+
+bool getLengths(Reader &reader, std::vector<Length> &lengths) {
+    std::uint32_t count;
+    if (!reader.getCount(count, sizeof(Length)))
+        return false;
+    lengths.resize(count);
+    for (Length &length : lengths)
+        reader.get(length);
+    return true;
+}
+
+} // namespace
+
+std::string Writer::finish(const char (&magic)[6]) const {
+    Writer header;
+    header.putBytes(magic, sizeof(magic));
+    header.put(formatVersion);
+    header.put(static_cast<std::uint32_t>(names.size()));
+    for (const std::string *name : names) {
+        header.put(static_cast<std::uint32_t>(name->size()));
+        header.putBytes(name->data(), name->size());
+    }
+    return header.body + body;
+}
+
+bool Reader::getHeader(const char (&magic)[6], std::uint16_t &version, std::vector<std::string> &names) {
+    if (!getMagic(magic))
+        return false;
+    if (!get(version) || version < oldestReadableVersion || version > formatVersion)
+        return true;  // The caller reports the version
+
+    std::uint32_t count;
+    if (!getCount(count, sizeof(std::uint32_t)))
+        return false;
+    names.resize(count);
+    for (auto &name : names) {
+        if (!getString(name))
+            return false;
+    }
+    return true;
+}
+
+bool isBinaryJob(const char *data, std::size_t size) {
+    return hasMagic(data, size, jobMagic);
+}
+
+std::string serializeJob(const CuttingJob &job) {
+    Writer writer;
+    writer.put(static_cast<std::uint32_t>(job.stock.size()));
+    for (const auto &stock : job.stock) {
+        writer.putName(stock.profileName);
+        writer.put(static_cast<std::int32_t>(stock.quantity));
+        writer.put(stock.length);
+        writer.put(stock.cost);
+    }
+    writer.put(static_cast<std::uint32_t>(job.cuts.size()));
+    for (const auto &cut : job.cuts) {
+        writer.putName(cut.profileName);
+        writer.put(static_cast<std::int32_t>(cut.quantity));
+        writer.put(cut.lengthToCut);
+    }
+    return writer.finish(jobMagic);
+}
+
+bool parseBinaryJobStock(const char *data, std::size_t size, std::vector<StockEntry> &stock, BinaryJobTable &table,
+                         std::string *errorMessage) {
+    Reader reader(data, size);
+    std::uint16_t version;
+    if (!readHeader(reader, jobMagic, "job", table.names, errorMessage, &version))
+        return false;
+
+    std::uint32_t count;
+    if (!reader.getCount(count, binaryJobRowSize))
+        return corrupt("job", errorMessage);
+    stock.resize(count);
+    for (auto &row : stock) {
+        std::int32_t quantity;
+        row.cost = 0.0;
+        if (!reader.getName(table.names, row.profileName) || !reader.get(quantity) || !reader.get(row.length)
+            || (version >= firstPricedVersion && !reader.get(row.cost)))
+            return corrupt("job", errorMessage);
+        row.quantity = quantity;
+    }
+
+    // The cut rows have to fill the rest of the file exactly
+    if (!reader.getCount(table.cutCount, binaryJobRowSize))
+        return corrupt("job", errorMessage);
+    table.cutsOffset = reader.current() - data;
+    return size - table.cutsOffset == std::size_t(table.cutCount) * binaryJobRowSize || corrupt("job", errorMessage);
+}
+
+bool parseBinaryJobCut(const char *data, const BinaryJobTable &table, std::uint32_t row, CutEntry &cut,
+                       std::string *errorMessage) {
+    Reader reader(data + table.cutsOffset + std::size_t(row) * binaryJobRowSize, binaryJobRowSize);
+    std::int32_t quantity;
+    if (!reader.getName(table.names, cut.profileName) || !reader.get(quantity) || !reader.get(cut.lengthToCut))
+        return corrupt("job", errorMessage);
+    cut.quantity = quantity;
+    return true;
+}
+
+bool parseBinaryJob(const char *data, std::size_t size, CuttingJob &job, std::string *errorMessage) {
+    BinaryJobTable table;
+    if (!parseBinaryJobStock(data, size, job.stock, table, errorMessage))
+        return false;
+    job.cuts.resize(table.cutCount);
+    for (std::uint32_t row = 0; row < table.cutCount; ++row) {
+        if (!parseBinaryJobCut(data, table, row, job.cuts[row], errorMessage))
+            return false;
+    }
+    return true;
+}
+
+bool isBinaryResult(const char *data, std::size_t size) {
+    return hasMagic(data, size, resultMagic);
+}
+
+std::string serializeResult(const CuttingResult &result) {
+    Writer writer;
+    writer.put(result.totalStockLength);
+    writer.put(result.usedStockLength);
+    writer.put(result.stockLowerBound);
+    writer.put(result.stockCost);
+    writer.put(result.stockCostLowerBound);
+    writer.put(static_cast<std::uint8_t>(result.stoppedEarly));
+
+    writer.put(static_cast<std::uint32_t>(result.schemes.size()));
+    for (const auto &scheme : result.schemes) {
+        writer.putName(scheme.profileName);
+        writer.put(static_cast<std::int32_t>(scheme.count));
+        writer.put(scheme.stockLength);
+        writer.put(scheme.remainder);
+        writer.put(static_cast<std::uint8_t>(scheme.fromRemnant));
+        writer.put(static_cast<std::uint32_t>(scheme.cuts.size()));
+        for (double cut : scheme.cuts)
+            writer.put(cut);
+    }
+
+    writer.put(static_cast<std::uint32_t>(result.shortages.size()));
+    for (const auto &shortage : result.shortages) {
+        writer.putName(shortage.profileName);
+        writer.put(static_cast<std::int32_t>(shortage.quantity));
+        writer.put(shortage.lengthToCut);
+        writer.put(static_cast<std::uint8_t>(shortage.noStock));
+    }
+    return writer.finish(resultMagic);
+}
+
+bool parseBinaryResult(const char *data, std::size_t size, CuttingResult &result, std::string *errorMessage) {
+    Reader reader(data, size);
+    std::vector<std::string> names;
+    std::uint16_t version;
+    if (!readHeader(reader, resultMagic, "result", names, errorMessage, &version))
+        return false;
+
+    std::uint8_t flag;
+    result.stockLowerBound = 0.0;
+    result.stockCost = 0.0;
+    result.stockCostLowerBound = 0.0;
+    if (!reader.get(result.totalStockLength) || !reader.get(result.usedStockLength)
+        || (version >= 2 && !reader.get(result.stockLowerBound))
+        || (version >= firstPricedVersion && (!reader.get(result.stockCost) || !reader.get(result.stockCostLowerBound)))
+        || !reader.get(flag))
+        return corrupt("result", errorMessage);
+    result.stoppedEarly = flag != 0;
+
+    std::uint32_t count;
+    const std::size_t schemeSize = 2 * sizeof(std::uint32_t) + sizeof(std::int32_t) + 2 * sizeof(double);
+    if (!reader.getCount(count, schemeSize))
+        return corrupt("result", errorMessage);
+    result.schemes.resize(count);
+    for (auto &scheme : result.schemes) {
+        std::int32_t bars;
+        std::uint32_t cuts;
+        if (!reader.getName(names, scheme.profileName) || !reader.get(bars) || !reader.get(scheme.stockLength)
+            || !reader.get(scheme.remainder) || (version >= 3 && !reader.get(flag)) || !reader.getCount(cuts, sizeof(double)))
+            return corrupt("result", errorMessage);
+        scheme.count = bars;
+        scheme.fromRemnant = version >= 3 && flag != 0;
+        scheme.cuts.resize(cuts);
+        for (double &cut : scheme.cuts)
+            reader.get(cut);
+    }
+
+    const std::size_t shortageSize = sizeof(std::uint32_t) + sizeof(std::int32_t) + sizeof(double) + 1;
+    if (!reader.getCount(count, shortageSize))
+        return corrupt("result", errorMessage);
+    result.shortages.resize(count);
+    for (auto &shortage : result.shortages) {
+        std::int32_t quantity;
+        if (!reader.getName(names, shortage.profileName) || !reader.get(quantity)
+            || !reader.get(shortage.lengthToCut) || !reader.get(flag))
+            return corrupt("result", errorMessage);
+        shortage.quantity = quantity;
+        shortage.noStock = flag != 0;
+    }
+
+    return reader.atEnd() || corrupt("result", errorMessage);
+}
+
+std::string serializeCheckpoint(const SolveCache::State &state) {
+    Writer writer;
+    writer.put(static_cast<std::uint8_t>(state.mode));
+    writer.put(state.lengthUnit);
+    writer.put(state.seed);
+    writer.put(static_cast<std::uint32_t>(state.searchStarts));
+    writer.put(static_cast<std::int32_t>(state.searchMoves));
+    writer.put(static_cast<std::uint8_t>(state.remnants));
+
+    writer.put(static_cast<std::uint32_t>(state.groups.size()));
+    for (const auto &entry : state.groups) {
+        const SolveCache::State::Group &group = entry.second;
+        writer.putName(entry.first);
+        writer.put(static_cast<std::uint32_t>(group.stock.size()));
+        for (const auto &stock : group.stock) {
+            writer.put(stock.length);
+            writer.put(static_cast<std::int32_t>(stock.available));
+            writer.put(stock.cost);
+        }
+        putLengths(writer, group.lengthsToCut);
+        putLengths(writer, group.remnants);
+        putLengths(writer, group.pieceLengths);
+        writer.put(group.stockLowerBound);
+        writer.put(static_cast<std::uint8_t>(group.final));
+
+        putSchemes(writer, group.plan.schemes);
+        putLengths(writer, group.plan.uncut);
+        writer.put(static_cast<std::uint8_t>(group.plan.noStock));
+        writer.put(static_cast<std::int32_t>(group.plan.missingPieces));
+        writer.put(group.plan.stockUsed);
+
+        putSchemes(writer, group.patterns);
+        writer.put(static_cast<std::int32_t>(group.searchRounds));
+        writer.put(static_cast<std::uint32_t>(group.searches.size()));
+        for (const auto &search : group.searches) {
+            writer.put(search.random);
+            putSchemes(writer, search.bars);
+        }
+    }
+    return writer.finish(checkpointMagic);
+}
+
+bool parseCheckpoint(const char *data, std::size_t size, SolveCache::State &state, std::string *errorMessage) {
+    Reader reader(data, size);
+    std::vector<std::string> names;
+    std::uint16_t version;
+    if (!readHeader(reader, checkpointMagic, "checkpoint", names, errorMessage, &version))
+        return false;
+    if (version < firstCheckpointVersion) {
+        if (errorMessage)
+            *errorMessage = "Unsupported binary checkpoint file version " + std::to_string(version);
+        return false;
+    }
+
+    std::uint8_t mode;
+    std::uint8_t flag;
+    std::uint32_t searchStarts;
+    std::int32_t searchMoves;
+    if (!reader.get(mode) || mode > static_cast<std::uint8_t>(SolverMode::LocalSearch) || !reader.get(state.lengthUnit)
+        || !reader.get(state.seed) || !reader.get(searchStarts) || !reader.get(searchMoves) || !reader.get(flag))
+        return corrupt("checkpoint", errorMessage);
+    state.mode = static_cast<SolverMode>(mode);
+    state.searchStarts = searchStarts;
+    state.searchMoves = searchMoves;
+    state.remnants = flag != 0;
+
+    std::uint32_t count;
+    if (!reader.getCount(count, sizeof(std::uint32_t)))
+        return corrupt("checkpoint", errorMessage);
+    state.groups.clear();
+    for (std::uint32_t g = 0; g < count; ++g) {
+        std::string name;
+        std::uint32_t rows;
+        if (!reader.getName(names, name) || !reader.getCount(rows, sizeof(Length) + sizeof(std::int32_t)))
+            return corrupt("checkpoint", errorMessage);
+        SolveCache::State::Group &group = state.groups[name];
+        group.stock.resize(rows);
+        for (auto &stock : group.stock) {
+            std::int32_t bars;
+            if (!reader.get(stock.length) || !reader.get(bars))
+                return corrupt("checkpoint", errorMessage);
+            stock.available = bars;
+            stock.cost = stock.length;
+            if (version >= firstPricedVersion && !reader.get(stock.cost))
+                return corrupt("checkpoint", errorMessage);
+        }
+        if (!getLengths(reader, group.lengthsToCut) || !getLengths(reader, group.remnants)
+            || !getLengths(reader, group.pieceLengths) || !reader.get(group.stockLowerBound) || !reader.get(flag))
+            return corrupt("checkpoint", errorMessage);
+        group.final = flag != 0;
+
+        std::int32_t number;
+        if (!getSchemes(reader, group, group.plan.schemes) || !getLengths(reader, group.plan.uncut) || !reader.get(flag)
+            || !reader.get(number) || !reader.get(group.plan.stockUsed))
+            return corrupt("checkpoint", errorMessage);
+        group.plan.noStock = flag != 0;
+        group.plan.missingPieces = number;
+
+        if (!getSchemes(reader, group, group.patterns) || !reader.get(number)
+            || !reader.getCount(rows, sizeof(std::uint64_t) + sizeof(std::uint32_t)))
+            return corrupt("checkpoint", errorMessage);
+        group.searchRounds = number;
+        group.searches.resize(rows);
+        for (auto &search : group.searches) {
+            if (!reader.get(search.random) || !getSchemes(reader, group, search.bars))
+                return corrupt("checkpoint", errorMessage);
+        }
+    }
+
+    return reader.atEnd() || corrupt("checkpoint", errorMessage);
+}
+
+bool writeFile(const std::string &fileName, const std::string &contents, std::string *errorMessage) {
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+    if (!file) {
+        if (errorMessage)
+            *errorMessage = "Cannot save file: " + fileName + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok && errorMessage)
+        *errorMessage = "Cannot save file: " + fileName;
+    return ok;
+}
+
+bool replaceFile(const std::string &fileName, const std::string &contents, std::string *errorMessage) {
+    const std::string temporary = fileName + ".tmp";
+    if (!writeFile(temporary, contents, errorMessage))
+        return false;
+    std::error_code error;
+    std::filesystem::rename(temporary, fileName, error);
+    if (error) {
+        if (errorMessage)
+            *errorMessage = "Cannot save file: " + fileName + " (" + error.message() + ")";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,172 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+// Internal to the solver: versioned binary job and result files. They hold the
+// same data as the text formats in native little-endian layout, with every
+// profile name stored once, so loading is little more than copying arrays.
+//
+// Job file, version 4:     "CUTJOB" u16 version, names, u32 stock rows of
+//                          (u32 name, i32 quantity, f64 length, f64 bar price
+//                          (not before version 4)), u32 cut rows of (u32 name,
+//                          i32 quantity, f64 length)
+// Result file, version 4:  "CUTRES" u16 version, names, f64 total stock,
+//                          f64 used stock, f64 stock lower bound (not in
+//                          version 1), f64 stock cost and f64 stock cost lower
+//                          bound (not before version 4), u8 stopped early, u32 schemes of
+//                          (u32 name, i32 count, f64 stock length, f64 remainder,
+//                          u8 from offcut (not before version 3), u32 cuts,
+//                          f64 cut lengths...), u32 shortages of
+//                          (u32 name, i32 quantity, f64 length, u8 no stock)
+// Checkpoint, version 4:   "CUTCKP" u16 version, names, u8 mode, f64 length
+//                          unit, u64 seed, u32 searches, i32 search moves,
+//                          u8 offcuts, u32 groups of (u32 name, u32 stock of
+//                          (i64 length, i32 bars, i64 cost (not before version
+//                          4, when it is the length)), u32 cuts of (i64 length,
+//                          i32 quantity), u32 offcuts of i64, u32 piece lengths
+//                          of i64, i64 lower bound, u8 final, plan, u32
+//                          patterns of scheme, i32 search rounds, u32 searches
+//                          of (u64 random state, u32 bars of scheme))
+// where names is a u32 count followed by (u32 byte length, bytes) per name, a
+// plan is u32 schemes, u32 uncut of (i64 length, i32 quantity), u8 no stock,
+// i32 missing pieces, i64 stock used, and a scheme is (i64 stock length, i64
+// remainder, i32 count, u32 cuts of u32 piece index). Checkpoint lengths are
+// in solver units, see SolverOptions::lengthUnit, and costs and stock used in
+// the same units, see StockClass::cost.
+// Files of earlier versions are still read, with no prices; version 1 and 2
+// jobs are the same as version 3 ones, and checkpoints start at version 3.
+
+#include "cutting_job.h"
+#include "cutting_solver.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+const char *const binaryJobExtension = ".cutjob";
+const char *const binaryResultExtension = ".cutres";
+
+bool isBinaryJob(const char *data, std::size_t size);
+std::string serializeJob(const CuttingJob &job);
+bool parseBinaryJob(const char *data, std::size_t size, CuttingJob &job, std::string *errorMessage);
+
+// A binary job read in parts, as JobReader does: the stock rows and name table
+// first, then any cut row on its own, since cut rows all have the same size.
+// Stock rows are at least that long.
+const std::size_t binaryJobRowSize = sizeof(std::uint32_t) + sizeof(std::int32_t) + sizeof(double);
+struct BinaryJobTable {
+    std::vector<std::string> names;
+    std::size_t cutsOffset = 0;  // Of the first cut row
+    std::uint32_t cutCount = 0;
+};
+bool parseBinaryJobStock(const char *data, std::size_t size, std::vector<StockEntry> &stock, BinaryJobTable &table,
+                         std::string *errorMessage);
+bool parseBinaryJobCut(const char *data, const BinaryJobTable &table, std::uint32_t row, CutEntry &cut,
+                       std::string *errorMessage);
+
+bool isBinaryResult(const char *data, std::size_t size);
+std::string serializeResult(const CuttingResult &result);
+bool parseBinaryResult(const char *data, std::size_t size, CuttingResult &result, std::string *errorMessage);
+
+std::string serializeCheckpoint(const SolveCache::State &state);
+bool parseCheckpoint(const char *data, std::size_t size, SolveCache::State &state, std::string *errorMessage);
+
+// Collects the body of a file and the names it refers to, then puts the
+// header and name table in front of it. Files of other layouts, like the
+// offcut store, take the bytes as they were put.
+class Writer {
+public:
+    template <typename T>
+    void put(T value) {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are written raw");
+        body.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    void putBytes(const char *data, std::size_t size) { body.append(data, size); }
+    // Zero bytes up to the next multiple of `alignment`
+    void align(std::size_t alignment) { body.resize((body.size() + alignment - 1) / alignment * alignment, '\0'); }
+
+    // Every name is stored once, in first-use order; rows refer to it by index
+    void putName(const std::string &name) {
+        auto inserted = nameIndices.emplace(name, static_cast<std::uint32_t>(names.size()));
+        if (inserted.second)
+            names.push_back(&inserted.first->first);
+        put(inserted.first->second);
+    }
+
+    // Magic, version and name table of the job, result and checkpoint formats, then the body
+    std::string finish(const char (&magic)[6]) const;
+    const std::string &contents() const { return body; }
+
+private:
+    std::string body;
+    std::unordered_map<std::string, std::uint32_t> nameIndices;
+    std::vector<const std::string *> names;
+};
+
+// Bounds-checked reads from a file image; every get fails once the data runs out
+class Reader {
+public:
+    Reader(const char *data, std::size_t size) : position(data), end(data + size) {}
+
+    template <typename T>
+    bool get(T &value) {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are read raw");
+        if (static_cast<std::size_t>(end - position) < sizeof(value))
+            return false;
+        std::memcpy(&value, position, sizeof(value));
+        position += sizeof(value);
+        return true;
+    }
+
+    bool getMagic(const char (&magic)[6]) {
+        if (static_cast<std::size_t>(end - position) < sizeof(magic) || std::memcmp(position, magic, sizeof(magic)) != 0)
+            return false;
+        position += sizeof(magic);
+        return true;
+    }
+
+    // u32 byte length and the bytes
+    bool getString(std::string &text) {
+        std::uint32_t size;
+        if (!getCount(size, 1))
+            return false;
+        text.assign(position, size);
+        position += size;
+        return true;
+    }
+
+    // Magic, version and name table of the job, result and checkpoint formats.
+    // A version this build cannot read is returned for the caller to report.
+    bool getHeader(const char (&magic)[6], std::uint16_t &version, std::vector<std::string> &names);
+
+    // A row count, checked against the bytes left so a corrupt file cannot make us allocate wildly
+    bool getCount(std::uint32_t &count, std::size_t rowSize) {
+        return get(count) && count <= static_cast<std::size_t>(end - position) / rowSize;
+    }
+
+    bool getName(const std::vector<std::string> &names, std::string &name) {
+        std::uint32_t index;
+        if (!get(index) || index >= names.size())
+            return false;
+        name = names[index];
+        return true;
+    }
+
+    bool atEnd() const { return position == end; }
+    const char *current() const { return position; }
+
+private:
+    const char *position;
+    const char *end;
+};
+
+// Write a whole buffer to a file, replacing it
+bool writeFile(const std::string &fileName, const std::string &contents, std::string *errorMessage);
+// The same, but written beside the file and renamed over it, so that neither
+// readers nor a crash ever see half a file
+bool replaceFile(const std::string &fileName, const std::string &contents, std::string *errorMessage);
+
+#endif // BINARY_FORMAT_H
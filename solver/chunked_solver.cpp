@@ -0,0 +1,455 @@
+#include "chunked_solver.h"
+#include "cut_pattern.h"
+#include "length.h"
+#include "profile_group.h"
+#include "remnant_store.h"
+#include "solve_stats.h"
+#include "task_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using LengthCounts = std::map<Length, int, std::greater<Length>>;
+using BarPattern = std::pair<Length, std::vector<Length>>;  // Stock length and cuts, longest first
+
+// The re-solve's pool is cut down to the patterns most bars use
+const std::size_t maxPoolPatterns = 20000;
+
+// What the chunks have made of one profile so far
+struct ProfileState {
+    LengthCounts stock;      // All of its bars
+    LengthCounts stockLeft;  // Bars no chunk has cut yet
+    std::map<Length, std::pair<double, int>> priced;  // Price and number of the bars with a price, by length
+    LengthCounts demand;     // Pieces read, less those cut from offcuts
+    std::map<BarPattern, int> bars;     // New bars cut, by pattern
+    std::map<BarPattern, int> offcuts;  // Offcuts cut, by pattern
+    LengthCounts uncut;
+    bool noStock = false;
+    Length lowerBound = 0;
+    std::vector<StockClass> costs;  // The bars as the re-solve priced them
+    double costRate = 0.0;
+    double costLowerBound = 0.0;
+};
+
+// The lengths a profile's job rows gave, for the report
+struct ProfileLengths {
+    explicit ProfileLengths(const LengthUnit &unit) : stock(unit), pieces(unit), offcuts(unit) {}
+
+    JobLengths stock;
+    JobLengths pieces;
+    JobLengths offcuts;
+};
+
+// One chunk of a wave
+struct Chunk {
+    CuttingJob job;
+    std::map<std::string, Length> shortestPiece;
+    CuttingResult result;
+};
+
+BarPattern barPattern(const CuttingScheme &scheme, const LengthUnit &unit) {
+    BarPattern pattern{unit.barFromJob(scheme.stockLength), {}};
+    for (double cut : scheme.cuts)
+        pattern.second.push_back(unit.pieceFromJob(cut));
+    std::sort(pattern.second.begin(), pattern.second.end(), std::greater<Length>());
+    return pattern;
+}
+
+// Average price of a bar of the length, 0 when none has one
+double barPrice(const ProfileState &profile, Length length) {
+    auto it = profile.priced.find(length);
+    return it == profile.priced.end() ? 0.0 : it->second.first / it->second.second;
+}
+
+bool hasBarFor(const LengthCounts &stock, Length length) {
+    return std::any_of(stock.begin(), stock.end(),
+                       [&](const std::pair<const Length, int> &bars) { return bars.first >= length && bars.second > 0; });
+}
+
+// Re-solve a profile's whole demand over the patterns its chunks cut, and keep
+// that plan if it cuts as many pieces from stock that costs less
+void solveProfileOverPool(const std::string &profileName, ProfileState &profile, const StopCondition &stop,
+                          SolveStats *stats) {
+    ProfileGroup group;
+    group.profileName = profileName;
+    std::vector<double> prices;
+    for (const auto &bars : profile.stock) {
+        group.stock.push_back({bars.first, bars.second, bars.first});
+        prices.push_back(barPrice(profile, bars.first));
+    }
+    priceStock(group, prices);
+    for (const auto &lengthAndQuantity : profile.demand) {
+        if (lengthAndQuantity.second > 0) {
+            group.lengthsToCut.emplace_back(lengthAndQuantity.first, lengthAndQuantity.second);
+            group.pieceLengths.push_back(lengthAndQuantity.first);
+        }
+    }
+    group.stockLowerBound = stockLowerBound(group);
+    profile.lowerBound = group.costRate > 0 ? stockLengthLowerBound(group) : group.stockLowerBound;
+    profile.costs = group.stock;
+    profile.costRate = group.costRate;
+    profile.costLowerBound = static_cast<double>(group.stockLowerBound) * group.costRate;
+    if (group.stock.empty() || group.pieceLengths.empty() || group.pieceLengths.size() > maxColumnGenerationLengths
+        || stop.shouldStop())
+        return;
+
+    PhaseTimer timer(stats, "chunks: re-solve", profileName.c_str());
+    std::vector<std::pair<int, const BarPattern *>> used;
+    for (const auto &bars : profile.bars)
+        used.emplace_back(bars.second, &bars.first);
+    std::sort(used.begin(), used.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    if (used.size() > maxPoolPatterns)
+        used.resize(maxPoolPatterns);
+
+    std::vector<GroupScheme> patterns;
+    for (const auto &countAndPattern : used) {
+        const BarPattern &pattern = *countAndPattern.second;
+        GroupScheme scheme{pattern.first, CutPattern(), pattern.first, 0};
+        bool known = true;
+        for (Length cut : pattern.second) {
+            known = known && std::binary_search(group.pieceLengths.begin(), group.pieceLengths.end(), cut, std::greater<Length>());
+            if (!known)
+                break;
+            scheme.cuts.push_back(pieceIndex(group, cut));
+            scheme.remainder -= cut;
+        }
+        if (known)
+            patterns.push_back(std::move(scheme));
+    }
+
+    std::vector<GroupScheme> schemes;
+    ProfileGroup work = group;
+    solveGroupOverPatterns(work, std::move(patterns), schemes, stop, stats);
+
+    std::vector<int> cut(group.pieceLengths.size(), 0);
+    Length stockUsed = 0;
+    for (const auto &scheme : schemes) {
+        stockUsed += barCost(group.stock, scheme.stockLength) * scheme.count;
+        for (CutPattern::Index index : scheme.cuts)
+            cut[index] += scheme.count;
+    }
+    int missing = 0;
+    LengthCounts uncut;
+    for (std::size_t i = 0; i < group.pieceLengths.size(); ++i) {
+        const int left = group.lengthsToCut[i].second - cut[i];
+        if (left > 0) {
+            uncut[group.pieceLengths[i]] = left;
+            missing += left;
+        }
+    }
+
+    Length chunkStockUsed = 0;
+    for (const auto &bars : profile.bars)
+        chunkStockUsed += barCost(group.stock, bars.first.first) * bars.second;
+    int chunkMissing = 0;
+    for (const auto &lengthAndQuantity : profile.uncut)
+        chunkMissing += lengthAndQuantity.second;
+    if (missing > chunkMissing || (missing == chunkMissing && stockUsed >= chunkStockUsed))
+        return;
+
+    profile.bars.clear();
+    for (const auto &scheme : schemes) {
+        BarPattern pattern{scheme.stockLength, {}};
+        for (CutPattern::Index index : scheme.cuts)
+            pattern.second.push_back(group.pieceLengths[index]);
+        std::sort(pattern.second.begin(), pattern.second.end(), std::greater<Length>());
+        profile.bars[pattern] += scheme.count;
+    }
+    profile.uncut = std::move(uncut);
+}
+
+} // namespace
+
+CuttingResult solveJobInChunks(JobReader &reader, const SolverOptions &options, const ChunkOptions &chunking) {
+    const auto start = std::chrono::steady_clock::now();
+    const LengthUnit unit(options.lengthUnit > 0 ? options.lengthUnit : reader.lengthUnit());
+    const unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const unsigned parallel = std::min(threads, chunking.parallelChunks ? chunking.parallelChunks : threads);
+    const long long chunkPieces = std::max(1LL, chunking.chunkPieces);
+    // Unfinished bars carried out of one chunk, in pieces; they all go to the
+    // first chunk of the next wave
+    const long long carryLimit = std::max(1LL, chunkPieces / (8 * parallel));
+
+    std::map<std::string, ProfileState> profiles;
+    std::map<std::string, ProfileLengths> jobLengths;
+    auto lengthsOf = [&](const std::string &profileName) -> ProfileLengths & {
+        return jobLengths.emplace(profileName, ProfileLengths(unit)).first->second;
+    };
+    double totalStockLength = 0.0;
+    for (const auto &stock : reader.stock()) {
+        if (stock.quantity <= 0)
+            continue;
+        const Length length = unit.barFromJob(stock.length);
+        lengthsOf(stock.profileName).stock.add(length, stock.length, stock.quantity);
+        ProfileState &profile = profiles[stock.profileName];
+        profile.stock[length] += stock.quantity;
+        if (stock.cost > 0) {
+            profile.priced[length].first += stock.cost * stock.quantity;
+            profile.priced[length].second += stock.quantity;
+        }
+        totalStockLength += stock.length * stock.quantity;
+    }
+    for (auto &entry : profiles)
+        entry.second.stockLeft = entry.second.stock;
+
+    // Each chunk has what is left of the time limit, and the solve's threads are
+    // shared out. Chunks work on the same grid as the whole order.
+    SolverOptions chunkOptions = options;
+    chunkOptions.lengthUnit = unit.size();
+    chunkOptions.threads = std::max(1u, threads / parallel);
+    chunkOptions.remnants = nullptr;
+    chunkOptions.cache = nullptr;
+    chunkOptions.checkpointFile.clear();
+    chunkOptions.onProgress = nullptr;
+    chunkOptions.onIncumbent = nullptr;
+    auto timeLeft = [&]() {
+        const double spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return options.timeLimit > 0 ? std::max(options.timeLimit - spent, 1e-3) : 0.0;
+    };
+
+    // One pool for every wave and the final re-solve; a wave uses as many of
+    // its threads as it has chunks
+    TaskPool pool(threads);
+    std::map<std::pair<std::string, Length>, int> carried;
+    long long carriedPieces = 0;
+    bool firstWave = true;
+    bool stoppedEarly = false;
+    while (!reader.atEnd() || !carried.empty()) {
+        // Carried pieces lead the first chunk, which still reads at least half a chunk
+        std::vector<Chunk> chunks(1);
+        for (const auto &carry : carried)
+            chunks[0].job.cuts.push_back({carry.first.first, unit.toJob(carry.first.second), carry.second});
+        const std::size_t carriedRows = chunks[0].job.cuts.size();
+        carried.clear();
+        reader.readCuts(std::max(chunkPieces - carriedPieces, (chunkPieces + 1) / 2), chunks[0].job.cuts);
+        carriedPieces = 0;
+        while (chunks.size() < parallel && !reader.atEnd()) {
+            chunks.emplace_back();
+            reader.readCuts(chunkPieces, chunks.back().job.cuts);
+        }
+        // A wave of one chunk has all of the stock; only there is a shortage final
+        const bool lastWave = reader.atEnd() && chunks.size() == 1;
+
+        // Each profile's bars are shared out in proportion to the length each chunk has to cut
+        std::map<std::string, std::vector<double>> need;
+        for (std::size_t c = 0; c < chunks.size(); ++c) {
+            for (std::size_t row = 0; row < chunks[c].job.cuts.size(); ++row) {
+                const CutEntry &cut = chunks[c].job.cuts[row];
+                if (cut.quantity <= 0)
+                    continue;
+                const Length length = unit.pieceFromJob(cut.lengthToCut);
+                ProfileState &profile = profiles[cut.profileName];
+                if (c > 0 || row >= carriedRows) {
+                    profile.demand[length] += cut.quantity;
+                    lengthsOf(cut.profileName).pieces.add(length, cut.lengthToCut, cut.quantity);
+                }
+                std::vector<double> &needs = need[cut.profileName];
+                needs.resize(chunks.size(), 0.0);
+                needs[c] += static_cast<double>(length) * cut.quantity;
+                auto shortest = chunks[c].shortestPiece.emplace(cut.profileName, length).first;
+                shortest->second = std::min(shortest->second, length);
+            }
+        }
+        for (const auto &entry : need) {
+            const double total = std::accumulate(entry.second.begin(), entry.second.end(), 0.0);
+            const ProfileState &profile = profiles[entry.first];
+            for (const auto &bars : profile.stockLeft) {
+                const double price = barPrice(profile, bars.first);
+                double before = 0.0;
+                int given = 0;
+                for (std::size_t c = 0; c < chunks.size(); ++c) {
+                    before += entry.second[c];
+                    const int upTo = c + 1 == chunks.size() || total <= 0 ? bars.second
+                                                                           : static_cast<int>(bars.second * (before / total));
+                    if (upTo > given)
+                        chunks[c].job.stock.push_back({entry.first, upTo - given, unit.toJob(bars.first), price});
+                    given = std::max(given, upTo);
+                }
+            }
+        }
+
+        std::vector<std::size_t> order(chunks.size());
+        std::iota(order.begin(), order.end(), 0);
+        chunkOptions.timeLimit = timeLeft();
+        pool.run(order, [&](std::size_t c) {
+            SolverOptions chunkOwn = chunkOptions;
+            if (firstWave && c == 0)
+                chunkOwn.remnants = options.remnants;
+            chunks[c].result = solveCuttingJob(chunks[c].job, chunkOwn);
+        });
+        firstWave = false;
+
+        // Keep the finished bars. Unfinished ones, with room for another piece,
+        // are uncut again and their pieces carried, most room first.
+        for (Chunk &chunk : chunks) {
+            stoppedEarly = stoppedEarly || chunk.result.stoppedEarly;
+            std::vector<std::pair<Length, const CuttingScheme *>> unfinished;
+            for (const auto &scheme : chunk.result.schemes) {
+                ProfileState &profile = profiles[scheme.profileName];
+                BarPattern pattern = barPattern(scheme, unit);
+                if (scheme.fromRemnant) {
+                    for (Length cut : pattern.second)
+                        profile.demand[cut] -= scheme.count;
+                    profile.offcuts[pattern] += scheme.count;
+                    continue;
+                }
+                Length remainder = pattern.first;
+                for (Length cut : pattern.second)
+                    remainder -= cut;
+                if (!lastWave && remainder >= chunk.shortestPiece[scheme.profileName]) {
+                    unfinished.emplace_back(remainder, &scheme);
+                    continue;
+                }
+                profile.bars[pattern] += scheme.count;
+                profile.stockLeft[pattern.first] -= scheme.count;
+            }
+
+            std::stable_sort(unfinished.begin(), unfinished.end(),
+                             [](const auto &a, const auto &b) { return a.first > b.first; });
+            long long carriedHere = 0;
+            for (const auto &remainderAndScheme : unfinished) {
+                const CuttingScheme &scheme = *remainderAndScheme.second;
+                ProfileState &profile = profiles[scheme.profileName];
+                BarPattern pattern = barPattern(scheme, unit);
+                const long long piecesPerBar = std::max<long long>(1, pattern.second.size());
+                const long long room = std::max(0LL, carryLimit - carriedHere);
+                const int carry = static_cast<int>(std::min<long long>(scheme.count, (room + piecesPerBar - 1) / piecesPerBar));
+                for (Length cut : pattern.second)
+                    carried[{scheme.profileName, cut}] += carry;
+                carriedHere += carry * piecesPerBar;
+                if (carry < scheme.count) {
+                    profile.bars[pattern] += scheme.count - carry;
+                    profile.stockLeft[pattern.first] -= scheme.count - carry;
+                }
+            }
+            carriedPieces += carriedHere;
+        }
+
+        // Pieces a chunk could not fit go on while some bar left could take them
+        for (Chunk &chunk : chunks) {
+            for (const auto &shortage : chunk.result.shortages) {
+                ProfileState &profile = profiles[shortage.profileName];
+                LengthCounts missing;
+                if (!shortage.noStock) {
+                    missing[unit.pieceFromJob(shortage.lengthToCut)] += shortage.quantity;
+                } else if (profile.stock.empty()) {
+                    profile.noStock = true;
+                    continue;
+                } else {
+                    // The chunk's share of the bars was none
+                    for (const auto &cut : chunk.job.cuts) {
+                        if (cut.profileName == shortage.profileName && cut.quantity > 0)
+                            missing[unit.pieceFromJob(cut.lengthToCut)] += cut.quantity;
+                    }
+                }
+                for (const auto &lengthAndQuantity : missing) {
+                    if (!lastWave && hasBarFor(profile.stockLeft, lengthAndQuantity.first)) {
+                        carried[{shortage.profileName, lengthAndQuantity.first}] += lengthAndQuantity.second;
+                        carriedPieces += lengthAndQuantity.second;
+                    } else {
+                        profile.uncut[lengthAndQuantity.first] += lengthAndQuantity.second;
+                    }
+                }
+            }
+        }
+
+        if (options.onProgress)
+            options.onProgress(0.9 * reader.fractionRead());
+    }
+
+    // The re-solve of every profile over its pool, biggest first
+    std::vector<std::map<std::string, ProfileState>::iterator> demanded;
+    for (auto it = profiles.begin(); it != profiles.end(); ++it) {
+        if (!it->second.demand.empty())
+            demanded.push_back(it);
+    }
+    std::vector<std::size_t> order(demanded.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return demanded[a]->second.demand.size() > demanded[b]->second.demand.size();
+    });
+    SolverOptions globalOptions = options;
+    globalOptions.timeLimit = timeLeft();
+    const StopCondition stop(globalOptions);
+    pool.run(order, [&](std::size_t p) {
+        solveProfileOverPool(demanded[p]->first, demanded[p]->second, stop, options.stats);
+    });
+    stoppedEarly = stoppedEarly || stop.shouldStop();
+
+    // Back to job lengths, laid out as solveCuttingJob lays out its plans
+    CuttingResult result;
+    Length lowerBound = 0;
+    for (auto it : demanded) {
+        const std::string &profileName = it->first;
+        const ProfileState &profile = it->second;
+        ProfileLengths &lengths = lengthsOf(profileName);
+        lowerBound += profile.lowerBound;
+        result.stockCostLowerBound += profile.costLowerBound;
+        if (options.remnants) {
+            for (auto offcut = options.remnants->begin(profileName); offcut != options.remnants->end(profileName); ++offcut) {
+                lengths.offcuts.add(unit.barFromJob(*offcut), *offcut, 1);
+                totalStockLength += *offcut;
+            }
+        }
+
+        auto report = [&](const std::map<BarPattern, int> &bars, bool fromRemnant) {
+            std::vector<const std::pair<const BarPattern, int> *> sorted;
+            for (const auto &entry : bars) {
+                if (entry.second > 0)
+                    sorted.push_back(&entry);
+            }
+            std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) {
+                if (a->first.first != b->first.first)
+                    return a->first.first > b->first.first;
+                return a->first.second > b->first.second;
+            });
+            for (const auto *entry : sorted) {
+                handOutBars(fromRemnant ? lengths.offcuts : lengths.stock, lengths.pieces, entry->first.first,
+                            entry->first.second, entry->second,
+                            [&](double stockLength, const std::vector<double> &jobCuts, int count) {
+                                CuttingScheme scheme;
+                                scheme.profileName = profileName;
+                                scheme.stockLength = stockLength;
+                                scheme.cuts = jobCuts;
+                                scheme.count = count;
+                                scheme.fromRemnant = fromRemnant;
+                                for (double cut : jobCuts) {
+                                    stockLength -= cut;
+                                    result.usedStockLength += cut * count;
+                                }
+                                scheme.remainder = std::max(0.0, stockLength);
+                                result.schemes.push_back(std::move(scheme));
+                            });
+                if (!fromRemnant)
+                    result.stockCost += static_cast<double>(barCost(profile.costs, entry->first.first)) * profile.costRate
+                                        * entry->second;
+            }
+        };
+        report(profile.offcuts, true);
+        report(profile.bars, false);
+
+        if (profile.noStock)
+            result.shortages.push_back({profileName, 0.0, 0, true});
+        for (const auto &lengthAndQuantity : profile.uncut)
+            handOutPieces(lengths.pieces, lengthAndQuantity.first, lengthAndQuantity.second, [&](double length, int quantity) {
+                result.shortages.push_back({profileName, length, quantity, false});
+            });
+    }
+    result.totalStockLength = totalStockLength;
+    result.stockLowerBound = unit.toJob(lowerBound);
+    result.stoppedEarly = stoppedEarly;
+    if (options.remnants)
+        options.remnants->identifyOffcuts(result);
+    if (options.onProgress)
+        options.onProgress(1.0);
+    return result;
+}
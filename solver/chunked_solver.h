@@ -0,0 +1,36 @@
+#ifndef CHUNKED_SOLVER_H
+#define CHUNKED_SOLVER_H
+
+// Orders too large to load or solve in one piece, such as the millions of
+// pieces of a year's framework contract, solved a chunk of the profile table at
+// a time. Chunks are read from the job file as they are needed and solved side
+// by side, each with a share of the stock; bars a chunk leaves unfinished and
+// pieces it could not fit go on to the next chunk, and a last pass re-solves
+// each profile's whole demand over the patterns the chunks cut. Memory grows
+// with the chunk size and the number of distinct patterns, not with the order.
+//
+// Chunks of 100 pieces or more cut about as much as a solve of the whole
+// order. Smaller ones pack worse, which the re-solve cannot make up for when
+// stock is short: on 60 scarce-stock orders of about 1100 pieces, 100-piece
+// chunks left fewer pieces uncut in total than whole solves in every mode,
+// 50-piece chunks up to 2% more.
+
+#include "cutting_job.h"
+#include "cutting_solver.h"
+
+#include <cstddef>
+
+struct ChunkOptions {
+    long long chunkPieces = 200000;  // Pieces read and solved together, whole profile rows at a time
+    unsigned parallelChunks = 0;     // Chunks solved at once, sharing options.threads; 0 for one per thread
+};
+
+// Solve the job the reader has opened, reading all of its profile rows. The
+// options are those of solveCuttingJob, except that there is no cache, no
+// checkpoint and no onIncumbent; offcuts go to the first chunk. The result is
+// a complete plan like solveCuttingJob's, with the lower bound of the whole
+// order.
+CuttingResult solveJobInChunks(JobReader &reader, const SolverOptions &options,
+                               const ChunkOptions &chunking = ChunkOptions());
+
+#endif // CHUNKED_SOLVER_H
@@ -0,0 +1,907 @@
+// Gilmore-Gomory column generation for the one-dimensional cutting stock problem.
+//
+// The master LP is   minimise  sum(stockCost[p] * x[p])
+//                    subject to sum(count[i][p] * x[p]) >= demand[i]
+//                               sum(x[p] over stock length k) <= available[k],  x >= 0
+// over a restricted set of cutting patterns p, where a pattern costs what its
+// bar does. Its duals price a bounded knapsack per stock length, whose value
+// against that length's cost either produces a pattern that improves the LP or
+// proves the LP optimal. The fractional solution is then rounded to whole bars.
+
+#include "profile_group.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+
+namespace {
+
+const double epsilon = 1e-9;
+
+struct Pattern {
+    int stockClass;
+    double cost;
+    std::vector<int> counts;   // Pieces of every item, dense over the items
+};
+
+// Revised simplex on the restricted master, with an explicit dense basis inverse.
+// The demand rows come first, then one row per stock length, kept as
+// -sum(x[p]) >= -available so every row has a surplus. Variable v < rowCount is
+// the surplus of row v, the next stockCount variables let the stock rows run
+// over their availability at a penalty, and variable v >= firstPattern is
+// pattern v - firstPattern. The overrun gives the start basis its feasibility
+// and is priced out of any solution the stock allows.
+class MasterProblem {
+public:
+    MasterProblem(const std::vector<int> &demand, const std::vector<StockClass> &stockClasses, double overrunCost);
+
+    // The first itemCount patterns must cut one item each, on the diagonal
+    void addPattern(Pattern pattern);
+    const std::vector<Pattern> &patternPool() const { return patterns; }
+
+    bool optimize();
+
+    // Demand rows first, then the stock rows; the knapsack reads only the former
+    const std::vector<double> &duals() const { return dual; }
+    double stockDual(int stockClass) const { return std::max(dual[itemCount + stockClass], 0.0); }
+    double objective() const;
+    bool overrun() const;  // Whether the solution uses more bars than some length has
+    std::vector<double> patternValues() const;
+
+private:
+    int itemCount;
+    int rowCount;
+    int firstPattern;
+    double overrunCost;
+    std::vector<double> rhs;
+    std::vector<Pattern> patterns;
+
+    // The same patterns in compressed sparse columns, which is what pricing walks
+    std::vector<double> patternCost;
+    std::vector<int> entryStart{0};
+    std::vector<int> entryItem;
+    std::vector<double> entryCount;
+
+    std::vector<int> basis;              // Variable in each basis row
+    std::vector<double> basisInverse;    // rowCount x rowCount, row major
+    std::vector<double> basicValues;
+    std::vector<double> dual;
+    std::vector<char> isBasic;
+
+    void startBasis();
+    bool refactor();
+    double basisResidual() const;
+    double variableCost(int variable) const;
+    void variableColumn(int variable, std::vector<double> &column) const;
+    void computeDuals();
+};
+
+MasterProblem::MasterProblem(const std::vector<int> &demand, const std::vector<StockClass> &stockClasses,
+                             double overrunCost)
+    : itemCount(static_cast<int>(demand.size())),
+      rowCount(static_cast<int>(demand.size() + stockClasses.size())),
+      firstPattern(static_cast<int>(demand.size() + 2 * stockClasses.size())),
+      overrunCost(overrunCost),
+      rhs(demand.begin(), demand.end()) {
+    for (const auto &stock : stockClasses)
+        rhs.push_back(-static_cast<double>(stock.available));
+}
+
+void MasterProblem::addPattern(Pattern pattern) {
+    for (int i = 0; i < itemCount; ++i) {
+        if (pattern.counts[i] != 0) {
+            entryItem.push_back(i);
+            entryCount.push_back(pattern.counts[i]);
+        }
+    }
+    entryItem.push_back(itemCount + pattern.stockClass);
+    entryCount.push_back(-1.0);
+    entryStart.push_back(static_cast<int>(entryItem.size()));
+    patternCost.push_back(pattern.cost);
+    patterns.push_back(std::move(pattern));
+}
+
+double MasterProblem::variableCost(int variable) const {
+    if (variable < rowCount)
+        return 0.0;
+    return variable < firstPattern ? overrunCost : patternCost[variable - firstPattern];
+}
+
+void MasterProblem::variableColumn(int variable, std::vector<double> &column) const {
+    column.assign(rowCount, 0.0);
+    if (variable < rowCount) {
+        column[variable] = -1.0;
+    } else if (variable < firstPattern) {
+        column[variable - rowCount + itemCount] = 1.0;
+    } else {
+        int p = variable - firstPattern;
+        for (int e = entryStart[p]; e < entryStart[p + 1]; ++e)
+            column[entryItem[e]] = entryCount[e];
+    }
+}
+
+// The diagonal patterns cover the demand rows. Each stock row keeps its surplus,
+// or its overrun when those patterns take more bars than it has, which leaves the
+// basis lower triangular with an inverse that can be written down directly.
+void MasterProblem::startBasis() {
+    const size_t n = rowCount;
+    basis.resize(n);
+    basisInverse.assign(n * n, 0.0);
+    basicValues.resize(n);
+
+    std::vector<double> barsUsed(rowCount - itemCount, 0.0);
+    for (int r = 0; r < itemCount; ++r) {
+        double count = patterns[r].counts[r];
+        basis[r] = firstPattern + r;
+        basisInverse[r * n + r] = 1.0 / count;
+        basicValues[r] = rhs[r] / count;
+        barsUsed[patterns[r].stockClass] += basicValues[r];
+    }
+    for (int k = 0; k < rowCount - itemCount; ++k) {
+        const size_t r = itemCount + k;
+        const double spare = -rhs[r] - barsUsed[k];
+        const double sign = spare >= 0 ? -1.0 : 1.0;  // Sign of the basic column
+        basis[r] = spare >= 0 ? static_cast<int>(r) : rowCount + k;
+        basisInverse[r * n + r] = sign;
+        basicValues[r] = std::fabs(spare);
+        for (int i = 0; i < itemCount; ++i) {
+            if (patterns[i].stockClass == k)
+                basisInverse[r * n + i] = sign / patterns[i].counts[i];
+        }
+    }
+}
+
+// Rebuild the basis inverse from scratch to get rid of accumulated rounding error
+bool MasterProblem::refactor() {
+    const size_t n = rowCount;
+    std::vector<double> matrix(n * n);
+    std::vector<double> column;
+    for (size_t c = 0; c < n; ++c) {
+        variableColumn(basis[c], column);
+        for (size_t r = 0; r < n; ++r)
+            matrix[r * n + c] = column[r];
+    }
+
+    std::vector<double> inverse(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i)
+        inverse[i * n + i] = 1.0;
+
+    // Gauss-Jordan elimination with partial pivoting
+    for (size_t c = 0; c < n; ++c) {
+        size_t pivotRow = c;
+        for (size_t r = c + 1; r < n; ++r) {
+            if (std::fabs(matrix[r * n + c]) > std::fabs(matrix[pivotRow * n + c]))
+                pivotRow = r;
+        }
+        if (std::fabs(matrix[pivotRow * n + c]) < epsilon)
+            return false;
+        if (pivotRow != c) {
+            std::swap_ranges(matrix.begin() + pivotRow * n, matrix.begin() + (pivotRow + 1) * n, matrix.begin() + c * n);
+            std::swap_ranges(inverse.begin() + pivotRow * n, inverse.begin() + (pivotRow + 1) * n, inverse.begin() + c * n);
+        }
+
+        double scale = 1.0 / matrix[c * n + c];
+        for (size_t k = 0; k < n; ++k) {
+            matrix[c * n + k] *= scale;
+            inverse[c * n + k] *= scale;
+        }
+        for (size_t r = 0; r < n; ++r) {
+            double factor = matrix[r * n + c];
+            if (r == c || factor == 0.0)
+                continue;
+            for (size_t k = 0; k < n; ++k) {
+                matrix[r * n + k] -= factor * matrix[c * n + k];
+                inverse[r * n + k] -= factor * inverse[c * n + k];
+            }
+        }
+    }
+
+    basisInverse.swap(inverse);
+    for (size_t r = 0; r < n; ++r) {
+        double value = 0.0;
+        for (size_t k = 0; k < n; ++k)
+            value += basisInverse[r * n + k] * rhs[k];
+        basicValues[r] = std::max(value, 0.0);
+    }
+    return true;
+}
+
+// Largest violation of B * x_B = rhs, relative to the right hand side
+double MasterProblem::basisResidual() const {
+    std::vector<double> residual(rhs);
+    for (int r = 0; r < rowCount; ++r) {
+        int variable = basis[r];
+        if (variable < rowCount) {
+            residual[variable] += basicValues[r];
+        } else if (variable < firstPattern) {
+            residual[variable - rowCount + itemCount] -= basicValues[r];
+        } else {
+            int p = variable - firstPattern;
+            for (int e = entryStart[p]; e < entryStart[p + 1]; ++e)
+                residual[entryItem[e]] -= entryCount[e] * basicValues[r];
+        }
+    }
+
+    double worst = 0.0;
+    for (int i = 0; i < rowCount; ++i)
+        worst = std::max(worst, std::fabs(residual[i]) / std::max(1.0, std::fabs(rhs[i])));
+    return worst;
+}
+
+// y = c_B^T B^-1
+void MasterProblem::computeDuals() {
+    const size_t n = rowCount;
+    dual.assign(n, 0.0);
+    for (size_t r = 0; r < n; ++r) {
+        double cost = variableCost(basis[r]);
+        if (cost == 0.0)
+            continue;
+        const double *row = &basisInverse[r * n];
+        for (size_t k = 0; k < n; ++k)
+            dual[k] += cost * row[k];
+    }
+}
+
+bool MasterProblem::optimize() {
+    if (basis.empty())
+        startBasis();
+
+    const int variableCount = firstPattern + static_cast<int>(patterns.size());
+    isBasic.assign(variableCount, 0);
+    for (int variable : basis)
+        isBasic[variable] = 1;
+
+    const size_t n = rowCount;
+    const int checkInterval = 100;
+    const int maxPivots = 50 * rowCount + 1000;
+    int degeneratePivots = 0;
+    std::vector<double> column;
+    std::vector<size_t> nonZeros;
+    std::vector<double> direction(n);
+
+    computeDuals();
+    for (int pivot = 1; pivot <= maxPivots; ++pivot) {
+        // Dantzig pricing, or Bland's rule once we seem to be stalling on a degenerate vertex
+        bool useBland = degeneratePivots > 50;
+        int entering = -1;
+        double bestReducedCost = -epsilon;
+        double enteringReducedCost = 0.0;
+        for (int variable = 0; variable < variableCount; ++variable) {
+            if (isBasic[variable])
+                continue;
+            double reducedCost;
+            double scaledReducedCost;
+            if (variable < rowCount) {
+                reducedCost = scaledReducedCost = dual[variable];
+            } else if (variable < firstPattern) {
+                reducedCost = overrunCost - dual[variable - rowCount + itemCount];
+                scaledReducedCost = reducedCost / overrunCost;
+            } else {
+                int p = variable - firstPattern;
+                reducedCost = patternCost[p];
+                for (int e = entryStart[p]; e < entryStart[p + 1]; ++e)
+                    reducedCost -= entryCount[e] * dual[entryItem[e]];
+                scaledReducedCost = reducedCost / patternCost[p];  // Compare patterns of different stock lengths fairly
+            }
+            if (scaledReducedCost < bestReducedCost) {
+                bestReducedCost = scaledReducedCost;
+                enteringReducedCost = reducedCost;
+                entering = variable;
+                if (useBland)
+                    break;
+            }
+        }
+        if (entering < 0)
+            return true;  // Optimal over the current pattern pool
+
+        // direction = B^-1 * column of the entering variable; columns are very sparse
+        variableColumn(entering, column);
+        nonZeros.clear();
+        for (size_t k = 0; k < n; ++k) {
+            if (column[k] != 0.0)
+                nonZeros.push_back(k);
+        }
+        for (size_t r = 0; r < n; ++r) {
+            const double *row = &basisInverse[r * n];
+            double value = 0.0;
+            for (size_t k : nonZeros)
+                value += row[k] * column[k];
+            direction[r] = value;
+        }
+
+        // Ratio test
+        int leavingRow = -1;
+        double bestRatio = 0.0;
+        for (size_t r = 0; r < n; ++r) {
+            if (direction[r] <= epsilon)
+                continue;
+            double ratio = basicValues[r] / direction[r];
+            if (leavingRow < 0 || ratio < bestRatio - epsilon
+                || (useBland && ratio <= bestRatio + epsilon && basis[r] < basis[leavingRow])) {
+                leavingRow = static_cast<int>(r);
+                bestRatio = ratio;
+            }
+        }
+        if (leavingRow < 0)
+            return false;  // Unbounded; cannot happen with positive costs
+
+        degeneratePivots = bestRatio <= epsilon ? degeneratePivots + 1 : 0;
+
+        // Pivot the basis inverse and the basic solution on (leavingRow, entering)
+        const size_t lr = leavingRow;
+        double pivotValue = direction[lr];
+        double *pivotRow = &basisInverse[lr * n];
+        for (size_t k = 0; k < n; ++k)
+            pivotRow[k] /= pivotValue;
+        basicValues[lr] = bestRatio;
+        for (size_t r = 0; r < n; ++r) {
+            if (r == lr || direction[r] == 0.0)
+                continue;
+            double factor = direction[r];
+            double *row = &basisInverse[r * n];
+            for (size_t k = 0; k < n; ++k)
+                row[k] -= factor * pivotRow[k];
+            basicValues[r] = std::max(basicValues[r] - factor * bestRatio, 0.0);
+        }
+
+        // y' = y + reducedCost * (new row of B^-1 for the pivot row)
+        for (size_t k = 0; k < n; ++k)
+            dual[k] += enteringReducedCost * pivotRow[k];
+
+        isBasic[basis[lr]] = 0;
+        isBasic[entering] = 1;
+        basis[lr] = entering;
+
+        // Refactoring is O(rows^3), so only do it when the updates have drifted
+        if (pivot % checkInterval == 0) {
+            if (basisResidual() > 1e-7 && !refactor())
+                return false;
+            computeDuals();
+        }
+    }
+    return false;
+}
+
+double MasterProblem::objective() const {
+    double value = 0.0;
+    for (int r = 0; r < rowCount; ++r)
+        value += variableCost(basis[r]) * basicValues[r];
+    return value;
+}
+
+bool MasterProblem::overrun() const {
+    for (int r = 0; r < rowCount; ++r) {
+        if (basis[r] >= rowCount && basis[r] < firstPattern && basicValues[r] > 1e-6)
+            return true;
+    }
+    return false;
+}
+
+std::vector<double> MasterProblem::patternValues() const {
+    std::vector<double> values(patterns.size(), 0.0);
+    for (int r = 0; r < rowCount; ++r) {
+        if (basis[r] >= firstPattern)
+            values[basis[r] - firstPattern] = basicValues[r];
+    }
+    return values;
+}
+
+// Bounded knapsack by dynamic programming over bar length, on a grid of `step`
+// units. Lengths are rounded up to the grid so every pattern found really fits.
+// Bounded counts are handled by binary splitting into 0-1 items.
+class KnapsackPricer {
+public:
+    KnapsackPricer(const std::vector<Length> &lengths, const std::vector<int> &limits, Length step);
+
+    // Best value of sum(values[i] * counts[i]) that fits into capacity
+    double solve(const std::vector<double> &values, Length capacity, std::vector<int> &counts);
+
+private:
+    std::vector<int> weights;
+    const std::vector<int> &limits;
+    Length step;
+
+    struct Chunk {
+        int item;
+        int multiplicity;
+    };
+    std::vector<Chunk> chunks;
+    std::vector<double> bestValue;       // Best value within each capacity
+    std::vector<uint64_t> takenBits;     // One bit per (chunk, capacity)
+};
+
+KnapsackPricer::KnapsackPricer(const std::vector<Length> &lengths, const std::vector<int> &limits, Length step)
+    : limits(limits), step(step) {
+    weights.reserve(lengths.size());
+    for (Length length : lengths)
+        weights.push_back(static_cast<int>(std::max<Length>(1, (length + step - 1) / step)));
+}
+
+double KnapsackPricer::solve(const std::vector<double> &values, Length capacity, std::vector<int> &counts) {
+    const int maxWeight = static_cast<int>(capacity / step);
+    counts.assign(weights.size(), 0);
+
+    chunks.clear();
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (values[i] <= epsilon || weights[i] > maxWeight)
+            continue;
+        int limit = std::min(limits[i], maxWeight / weights[i]);
+        for (int multiplicity = 1; limit > 0; multiplicity *= 2) {
+            int take = std::min(multiplicity, limit);
+            chunks.push_back({static_cast<int>(i), take});
+            limit -= take;
+        }
+    }
+
+    const size_t words = (static_cast<size_t>(maxWeight) + 64) / 64;
+    bestValue.assign(maxWeight + 1, 0.0);
+    takenBits.assign(chunks.size() * words, 0);
+
+    for (size_t j = 0; j < chunks.size(); ++j) {
+        const int weight = weights[chunks[j].item] * chunks[j].multiplicity;
+        const double value = values[chunks[j].item] * chunks[j].multiplicity;
+        uint64_t *taken = &takenBits[j * words];
+        for (int c = maxWeight; c >= weight; --c) {
+            double candidate = bestValue[c - weight] + value;
+            if (candidate > bestValue[c]) {
+                bestValue[c] = candidate;
+                taken[c / 64] |= uint64_t(1) << (c % 64);
+            }
+        }
+    }
+
+    // Walk the decisions back from the full capacity
+    int c = maxWeight;
+    for (size_t j = chunks.size(); j-- > 0;) {
+        if (takenBits[j * words + c / 64] & (uint64_t(1) << (c % 64))) {
+            counts[chunks[j].item] += chunks[j].multiplicity;
+            c -= weights[chunks[j].item] * chunks[j].multiplicity;
+        }
+    }
+    return bestValue[maxWeight];
+}
+
+// Grid for the pricing problem. The greatest common divisor of all lengths keeps
+// the knapsack exact; only bars of more than maxCells grid cells fall back to a
+// coarser grid, with lengths rounded up so patterns still fit.
+Length pricingStep(const std::vector<Length> &lengths, const std::vector<StockClass> &stockClasses) {
+    const Length maxCells = 1 << 17;
+    Length step = 0;
+    for (Length length : lengths)
+        step = std::gcd(step, length);
+    for (const auto &stock : stockClasses)
+        step = std::gcd(step, stock.length);
+    step = std::max<Length>(step, 1);
+
+    const Length cells = stockClasses.front().length / step;
+    if (cells > maxCells)
+        step *= (cells + maxCells - 1) / maxCells;
+    return step;
+}
+
+// The patterns the greedy fill produces for one stock length: longest cuts
+// first, repeated while the remaining demand allows
+std::vector<std::vector<int>> greedyPatterns(const std::vector<Length> &lengths, std::vector<int> demand, Length capacity) {
+    std::vector<std::vector<int>> patterns;
+    while (true) {
+        std::vector<int> counts(lengths.size(), 0);
+        Length room = capacity;
+        bool empty = true;
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            counts[i] = static_cast<int>(std::min<Length>(demand[i], room / lengths[i]));
+            room -= counts[i] * lengths[i];
+            empty = empty && counts[i] == 0;
+        }
+        if (empty)
+            break;
+
+        int copies = std::numeric_limits<int>::max();
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            if (counts[i] > 0)
+                copies = std::min(copies, demand[i] / counts[i]);
+        }
+        for (size_t i = 0; i < lengths.size(); ++i)
+            demand[i] -= counts[i] * copies;
+        patterns.push_back(std::move(counts));
+    }
+    return patterns;
+}
+
+// Fill one bar by decreasing dual value per unit length
+double greedyPrice(const std::vector<Length> &lengths, const std::vector<int> &limits,
+                   const std::vector<double> &values, Length capacity, std::vector<int> &counts) {
+    std::vector<int> order;
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        if (values[i] > epsilon)
+            order.push_back(static_cast<int>(i));
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return values[a] * lengths[b] > values[b] * lengths[a];
+    });
+
+    counts.assign(lengths.size(), 0);
+    Length room = capacity;
+    double value = 0.0;
+    for (int item : order) {
+        counts[item] = static_cast<int>(std::min<Length>(limits[item], room / lengths[item]));
+        room -= counts[item] * lengths[item];
+        value += counts[item] * values[item];
+    }
+    return value;
+}
+
+// Solve the LP relaxation for the given demand by column generation, seeded
+// with earlier patterns, and return the final pattern pool with the LP value of
+// every pattern. No stock length gives more bars than it has left. `tolerance`
+// is the relative optimality gap at which column generation stops. `bound` is
+// set to a proven lower bound on the LP value, or 0 when the pricing grid was
+// too coarse to prove one or the stock cannot cover the demand. Returns false
+// when there is no usable relaxation, including when `stop` fired; `patterns`
+// then holds the pool priced so far. Without `pricing` the LP is solved over
+// the starting patterns alone, with no bound.
+bool solveRelaxation(const std::vector<Length> &lengths, const std::vector<int> &demand,
+                     const std::vector<StockClass> &stockClasses, const std::vector<Pattern> &seeds,
+                     double tolerance, bool pricing, const StopCondition &stop, SolveStats *stats,
+                     std::vector<Pattern> &patterns, std::vector<double> &values, double &bound) {
+    const int itemCount = static_cast<int>(lengths.size());
+    std::vector<size_t> usableClasses;
+    for (size_t k = 0; k < stockClasses.size(); ++k) {
+        if (stockClasses[k].available > 0)
+            usableClasses.push_back(k);
+    }
+    if (usableClasses.empty())
+        return false;
+
+    // One bar more of some length saves at most the bars its pieces would
+    // otherwise take one each, so running over the stock must cost more than that
+    Length dearestBar = 0;
+    for (size_t k : usableClasses)
+        dearestBar = std::max(dearestBar, stockClasses[k].cost);
+    const double overrunCost = static_cast<double>(dearestBar) * (stockClasses.front().length / lengths.back() + 2);
+    MasterProblem master(demand, stockClasses, overrunCost);
+
+    // Start from homogeneous patterns, each on the stock length that cuts them cheapest
+    for (int i = 0; i < itemCount; ++i) {
+        Pattern best{-1, 0.0, {}};
+        double bestCostPerPiece = 0.0;
+        for (size_t k : usableClasses) {
+            int pieces = static_cast<int>(std::min<Length>(demand[i], stockClasses[k].length / lengths[i]));
+            if (pieces <= 0)
+                continue;
+            double costPerPiece = static_cast<double>(stockClasses[k].cost) / pieces;
+            if (best.stockClass < 0 || costPerPiece < bestCostPerPiece) {
+                best.stockClass = static_cast<int>(k);
+                best.cost = static_cast<double>(stockClasses[k].cost);
+                best.counts.assign(itemCount, 0);
+                best.counts[i] = pieces;
+                bestCostPerPiece = costPerPiece;
+            }
+        }
+        if (best.stockClass < 0)
+            return false;
+        master.addPattern(std::move(best));
+    }
+
+    // Earlier patterns, cut down to what is still needed
+    for (const auto &seed : seeds) {
+        if (stockClasses[seed.stockClass].available == 0)
+            continue;
+        Pattern pattern{seed.stockClass, seed.cost, seed.counts};
+        bool empty = true;
+        for (int i = 0; i < itemCount; ++i) {
+            pattern.counts[i] = std::min(pattern.counts[i], demand[i]);
+            empty = empty && pattern.counts[i] == 0;
+        }
+        if (!empty)
+            master.addPattern(std::move(pattern));
+    }
+
+    // Also offer the patterns the greedy fill would cut, which gives the LP a good start
+    for (size_t k : usableClasses) {
+        for (auto &pattern : greedyPatterns(lengths, demand, stockClasses[k].length)) {
+            master.addPattern({static_cast<int>(k), static_cast<double>(stockClasses[k].cost), std::move(pattern)});
+        }
+    }
+
+    // Farley's bound needs the best pattern value, which a coarse grid can miss
+    const Length step = pricingStep(lengths, stockClasses);
+    bool exactPricing = true;
+    for (Length length : lengths)
+        exactPricing = exactPricing && length % step == 0;
+    for (size_t k : usableClasses)
+        exactPricing = exactPricing && stockClasses[k].length % step == 0;
+
+    KnapsackPricer pricer(lengths, demand, step);
+    std::vector<int> counts;
+    double lowerBound = 0.0;
+    double cheapestBar = static_cast<double>(stockClasses[usableClasses.front()].cost);
+    for (size_t k : usableClasses)
+        cheapestBar = std::min(cheapestBar, static_cast<double>(stockClasses[k].cost));
+    const int maxIterations = 1000;
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        if (stop.shouldStop() || !master.optimize()) {
+            patterns = master.patternPool();
+            values.clear();
+            return false;
+        }
+        if (stats)
+            stats->add(SolveStats::ImprovementIterations);
+
+        const std::vector<double> &duals = master.duals();
+        const double objective = master.objective();
+        if (!pricing)
+            break;
+
+        // A pattern pays off when its pieces are worth more than its bar, plus
+        // what the bar is worth elsewhere while its length runs short
+        auto worthCutting = [&](size_t k) {
+            return static_cast<double>(stockClasses[k].cost) + master.stockDual(static_cast<int>(k));
+        };
+
+        // Cheap density-ordered fill first; the exact knapsack only when that finds nothing
+        bool improved = false;
+        for (size_t k : usableClasses) {
+            const double cost = static_cast<double>(stockClasses[k].cost);
+            double value = greedyPrice(lengths, demand, duals, stockClasses[k].length, counts);
+            if (value > worthCutting(k) * (1 + 1e-7)) {
+                master.addPattern({static_cast<int>(k), cost, counts});
+                improved = true;
+                if (stats)
+                    stats->add(SolveStats::PatternsGenerated);
+            }
+        }
+        if (improved)
+            continue;
+
+        double bestRatio = 1.0;
+        for (size_t k : usableClasses) {
+            const double cost = static_cast<double>(stockClasses[k].cost);
+            double value = pricer.solve(duals, stockClasses[k].length, counts);
+            bestRatio = std::max(bestRatio, value / worthCutting(k));
+            if (value > worthCutting(k) * (1 + 1e-7)) {
+                master.addPattern({static_cast<int>(k), cost, counts});
+                improved = true;
+                if (stats)
+                    stats->add(SolveStats::PatternsGenerated);
+            }
+        }
+
+        // Farley's bound: the demand duals scaled down by bestRatio, with the stock
+        // duals as they are, are feasible for the dual LP. The LP value settles
+        // long before it is proven, so stop once it is within half the cheapest
+        // bar or the relative tolerance; rounding to whole bars costs more than that.
+        double demandValue = 0.0;
+        for (int i = 0; i < itemCount; ++i)
+            demandValue += std::max(duals[i], 0.0) * demand[i];
+        double stockValue = 0.0;
+        for (size_t k : usableClasses)
+            stockValue += master.stockDual(static_cast<int>(k)) * stockClasses[k].available;
+        lowerBound = std::max(lowerBound, demandValue / bestRatio - stockValue);
+        if (!improved || objective - lowerBound <= std::max(0.5 * cheapestBar, tolerance * objective))
+            break;
+    }
+
+    patterns = master.patternPool();
+    values = master.patternValues();
+    bound = exactPricing && !master.overrun() ? lowerBound : 0.0;
+    return true;
+}
+
+// Cut up to `times` bars with the pattern, never cutting more pieces than are
+// still needed. Returns the number of bars used.
+int applyPattern(const Pattern &pattern, int times, const std::vector<Length> &lengths,
+                 const std::vector<CutPattern::Index> &pieces, std::vector<int> &remaining, std::vector<StockClass> &stockClasses,
+                 std::vector<GroupScheme> &schemes) {
+    StockClass &stock = stockClasses[pattern.stockClass];
+    int used = 0;
+    while (times > 0 && stock.available > 0) {
+        // How many full copies fit the remaining demand
+        int copies = std::min(times, stock.available);
+        std::vector<int> counts = pattern.counts;
+        bool empty = true;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (counts[i] == 0)
+                continue;
+            copies = std::min(copies, remaining[i] / counts[i]);
+            counts[i] = std::min(counts[i], remaining[i]);
+            empty = empty && counts[i] == 0;
+        }
+        if (empty)
+            break;
+        if (copies == 0)
+            copies = 1;  // Cut one trimmed copy
+        else
+            counts = pattern.counts;
+
+        GroupScheme scheme{stock.length, CutPattern(), 0, copies};
+        Length remainder = stock.length;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            for (int c = 0; c < counts[i]; ++c) {
+                scheme.cuts.push_back(pieces[i]);
+                remainder -= lengths[i];
+            }
+            remaining[i] -= counts[i] * copies;
+        }
+        scheme.remainder = remainder;
+        schemes.push_back(std::move(scheme));
+
+        stock.available -= copies;
+        times -= copies;
+        used += copies;
+    }
+    return used;
+}
+
+// Column generation, or with no `pricing` the LP over the pool alone
+bool solveGroupOverPool(ProfileGroup &group, std::vector<GroupScheme> &schemes, const StopCondition &stop,
+                        Length incumbentStock, SolveStats *stats, std::vector<GroupScheme> *patternPool, bool pricing) {
+    std::vector<StockClass> stockClasses = group.stock;
+    if (stockClasses.empty())
+        return true;
+    const Length longestStock = stockClasses.front().length;
+
+    // Distinct positive cut lengths that fit into some bar; anything else is left to the greedy pass
+    std::map<Length, int, std::greater<Length>> demandByLength;
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        if (lengthAndQuantity.first > 0 && lengthAndQuantity.first <= longestStock && lengthAndQuantity.second > 0)
+            demandByLength[lengthAndQuantity.first] += lengthAndQuantity.second;
+    }
+
+    std::vector<Length> lengths;
+    std::vector<CutPattern::Index> pieces;
+    std::vector<int> remaining;
+    for (const auto &entry : demandByLength) {
+        lengths.push_back(entry.first);
+        pieces.push_back(pieceIndex(group, entry.first));
+        remaining.push_back(entry.second);
+    }
+
+    // An earlier pool in this solve's terms; patterns of lengths or bars it does
+    // not use any more are dropped
+    std::vector<Pattern> earlierPatterns;
+    if (patternPool) {
+        for (const GroupScheme &scheme : *patternPool) {
+            auto stock = std::find_if(stockClasses.begin(), stockClasses.end(),
+                                      [&](const StockClass &stockClass) { return stockClass.length == scheme.stockLength; });
+            if (stock == stockClasses.end())
+                continue;
+            Pattern pattern{static_cast<int>(stock - stockClasses.begin()), static_cast<double>(stock->cost),
+                            std::vector<int>(lengths.size(), 0)};
+            for (CutPattern::Index cut : scheme.cuts) {
+                auto it = std::find(pieces.begin(), pieces.end(), cut);
+                if (it == pieces.end()) {
+                    pattern.stockClass = -1;
+                    break;
+                }
+                ++pattern.counts[it - pieces.begin()];
+            }
+            if (pattern.stockClass >= 0)
+                earlierPatterns.push_back(std::move(pattern));
+        }
+    }
+
+    // Round the LP solution down and re-solve what is left a few times. Each pass
+    // cuts far fewer bars than the one before, so the residual LPs are solved
+    // loosely and the greedy pass finishes whatever remains.
+    std::vector<Pattern> patterns;
+    std::vector<double> values;
+    const int maxRoundingPasses = 4;
+    for (int pass = 0; pass < maxRoundingPasses; ++pass) {
+        if (std::all_of(remaining.begin(), remaining.end(), [](int quantity) { return quantity == 0; }))
+            break;
+
+        // Only items that are still needed take part, which keeps the LP small
+        std::vector<size_t> active;
+        std::vector<Length> activeLengths;
+        std::vector<int> activeDemand;
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            if (remaining[i] > 0) {
+                active.push_back(i);
+                activeLengths.push_back(lengths[i]);
+                activeDemand.push_back(remaining[i]);
+            }
+        }
+
+        // Seed with the support of the previous LP; the rest of its pool rarely matters
+        std::vector<Pattern> seeds = pass == 0 ? std::move(earlierPatterns) : std::vector<Pattern>();
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            const Pattern &pattern = patterns[p];
+            if (values[p] <= 1e-6)
+                continue;
+            Pattern seed{pattern.stockClass, pattern.cost, std::vector<int>(active.size())};
+            for (size_t j = 0; j < active.size(); ++j)
+                seed.counts[j] = pattern.counts[active[j]];
+            seeds.push_back(std::move(seed));
+        }
+
+        double tolerance = pass == 0 ? 1e-3 : 1e-2;
+        double bound = 0.0;
+        const bool relaxed = solveRelaxation(activeLengths, activeDemand, stockClasses, seeds, tolerance, pricing, stop,
+                                             stats, patterns, values, bound);
+
+        // The first LP covers every item, so its pool is what a later solve can start from
+        if (pass == 0 && patternPool) {
+            patternPool->clear();
+            for (size_t p = 0; p < patterns.size(); ++p) {
+                if (relaxed && values[p] <= 1e-6)
+                    continue;
+                GroupScheme scheme{stockClasses[patterns[p].stockClass].length, CutPattern(), 0, 0};
+                for (size_t i = 0; i < lengths.size(); ++i) {
+                    for (int c = 0; c < patterns[p].counts[i]; ++c)
+                        scheme.cuts.push_back(pieces[i]);
+                }
+                scheme.remainder = scheme.stockLength;
+                for (CutPattern::Index cut : scheme.cuts)
+                    scheme.remainder -= group.pieceLengths[cut];
+                patternPool->push_back(std::move(scheme));
+            }
+        }
+        if (!relaxed)
+            break;
+
+        // The first relaxation covers the whole demand, so its bound holds for the
+        // group. With a single stock length it rounds up to whole bars.
+        if (pass == 0 && bound > 0) {
+            const Length onlyBar = stockClasses.back().cost;
+            const double slack = 1e-6 * bound;
+            Length lpBound = stockClasses.size() == 1
+                                 ? static_cast<Length>(std::ceil((bound - slack) / onlyBar)) * onlyBar
+                                 : static_cast<Length>(std::ceil(bound - slack));
+            group.stockLowerBound = std::max(group.stockLowerBound, lpBound);
+            if (incumbentStock > 0 && incumbentStock <= group.stockLowerBound)
+                return false;
+        }
+
+        for (auto &pattern : patterns) {
+            std::vector<int> counts(lengths.size(), 0);
+            for (size_t j = 0; j < active.size(); ++j)
+                counts[active[j]] = pattern.counts[j];
+            pattern.counts.swap(counts);
+        }
+
+        int usedBars = 0;
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            int times = static_cast<int>(std::floor(values[p] + 1e-6));
+            if (times > 0)
+                usedBars += applyPattern(patterns[p], times, lengths, pieces, remaining, stockClasses, schemes);
+        }
+        if (usedBars == 0)
+            break;
+    }
+
+    // Hand the rest of the demand and the unused bars to the greedy pass
+    for (auto &lengthAndQuantity : group.lengthsToCut) {
+        auto it = demandByLength.find(lengthAndQuantity.first);
+        if (it == demandByLength.end())
+            continue;
+        size_t i = std::distance(demandByLength.begin(), it);
+        int covered = std::min(lengthAndQuantity.second, it->second - remaining[i]);
+        lengthAndQuantity.second -= covered;
+        it->second -= covered;
+    }
+
+    group.stock.clear();
+    for (const auto &stock : stockClasses) {
+        if (stock.available > 0)
+            group.stock.push_back(stock);
+    }
+
+    solveGroupGreedy(group, schemes);
+    return true;
+}
+
+} // namespace
+
+bool solveGroupColumnGeneration(ProfileGroup &group, std::vector<GroupScheme> &schemes, const StopCondition &stop,
+                                Length incumbentStock, SolveStats *stats, std::vector<GroupScheme> *patterns) {
+    return solveGroupOverPool(group, schemes, stop, incumbentStock, stats, patterns, true);
+}
+
+void solveGroupOverPatterns(ProfileGroup &group, std::vector<GroupScheme> patterns, std::vector<GroupScheme> &schemes,
+                            const StopCondition &stop, SolveStats *stats) {
+    solveGroupOverPool(group, schemes, stop, 0, stats, &patterns, false);
+}
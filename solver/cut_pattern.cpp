@@ -0,0 +1,83 @@
+#include "cut_pattern.h"
+
+#include <algorithm>
+
+namespace {
+
+// Final step of splitmix64, a cheap and well mixed 64-bit hash
+std::uint64_t mix(std::uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+} // namespace
+
+void CutPattern::push_back(Index index) {
+    if (heapCuts.empty() && count < inlineCapacity) {
+        inlineCuts[count++] = index;
+        return;
+    }
+    if (heapCuts.empty())
+        heapCuts.assign(inlineCuts.begin(), inlineCuts.begin() + count);
+    heapCuts.push_back(index);
+    count++;
+}
+
+void CutPattern::canonicalize() {
+    Index *first = heapCuts.empty() ? inlineCuts.data() : heapCuts.data();
+    std::sort(first, first + count);
+}
+
+std::uint64_t CutPattern::hash() const {
+    std::uint64_t value = count;
+    for (Index index : *this)
+        value = mix(value + index);
+    return value;
+}
+
+bool CutPattern::operator==(const CutPattern &other) const {
+    return count == other.count && std::equal(begin(), end(), other.begin());
+}
+
+bool CutPattern::operator<(const CutPattern &other) const {
+    return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+}
+
+std::uint64_t SchemeCounter::keyHash(const GroupScheme &scheme) {
+    return mix(scheme.cuts.hash() ^ static_cast<std::uint64_t>(scheme.stockLength));
+}
+
+void SchemeCounter::add(const GroupScheme &scheme) {
+    // Keep the table at most half full
+    if (2 * (entries.size() + 1) > slots.size())
+        grow();
+
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t slot = keyHash(scheme) & mask;; slot = (slot + 1) & mask) {
+        if (slots[slot] == 0) {
+            entries.push_back(scheme);
+            slots[slot] = static_cast<std::uint32_t>(entries.size());
+            return;
+        }
+        GroupScheme &entry = entries[slots[slot] - 1];
+        if (entry.stockLength == scheme.stockLength && entry.cuts == scheme.cuts) {
+            entry.count += scheme.count;
+            return;
+        }
+    }
+}
+
+void SchemeCounter::grow() {
+    slots.assign(std::max<std::size_t>(16, 2 * slots.size()), 0);
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        std::size_t slot = keyHash(entries[i]) & mask;
+        while (slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = static_cast<std::uint32_t>(i + 1);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef CUT_PATTERN_H
+#define CUT_PATTERN_H
+
+// Internal to the solver: compact keys for counting identical bars.
+
+#include "length.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The cuts of one bar as indices into the group's distinct piece lengths,
+// sorted so that equal bars have equal patterns. Bars with up to inlineCapacity
+// cuts, which is nearly all of them, need no heap allocation.
+class CutPattern {
+public:
+    using Index = std::uint32_t;
+
+    void push_back(Index index);
+    void canonicalize();  // Sort ascending, which is longest piece first
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Index *begin() const { return heapCuts.empty() ? inlineCuts.data() : heapCuts.data(); }
+    const Index *end() const { return begin() + count; }
+
+    std::uint64_t hash() const;
+    bool operator==(const CutPattern &other) const;
+    bool operator<(const CutPattern &other) const;
+
+private:
+    static const std::size_t inlineCapacity = 14;
+
+    std::uint32_t count = 0;
+    std::array<Index, inlineCapacity> inlineCuts;
+    std::vector<Index> heapCuts;  // Used instead of inlineCuts once they are full
+};
+
+// A way of cutting one bar of a group, in solver units. Turned into a
+// CuttingScheme only when the plan is reported.
+struct GroupScheme {
+    Length stockLength;
+    CutPattern cuts;
+    Length remainder;
+    int count;  // Bars cut like this
+};
+
+// Adds up the bars of identical schemes. Open addressing with linear probing
+// over a power-of-two table of indices into the scheme list.
+class SchemeCounter {
+public:
+    void add(const GroupScheme &scheme);
+
+    std::vector<GroupScheme> &schemes() { return entries; }
+
+private:
+    static std::uint64_t keyHash(const GroupScheme &scheme);
+    void grow();
+
+    std::vector<GroupScheme> entries;
+    std::vector<std::uint32_t> slots;  // Entry index + 1, 0 for an empty slot
+};
+
+#endif // CUT_PATTERN_H
@@ -0,0 +1,343 @@
+#include "cutting_job.h"
+#include "binary_format.h"
+#include "mapped_file.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// A piece of the input, not copied
+struct Field {
+    const char *begin;
+    const char *end;
+
+    bool startsWith(const char *prefix) const {
+        std::size_t length = std::strlen(prefix);
+        return static_cast<std::size_t>(end - begin) >= length && std::memcmp(begin, prefix, length) == 0;
+    }
+
+    Field trimmed() const {
+        Field field = *this;
+        while (field.begin < field.end && (*field.begin == ' ' || *field.begin == '\t'))
+            field.begin++;
+        while (field.end > field.begin && (field.end[-1] == ' ' || field.end[-1] == '\t'))
+            field.end--;
+        return field;
+    }
+
+    bool empty() const { return begin == end; }
+    std::string text() const { return std::string(begin, end); }
+};
+
+// The whole field has to be the number, apart from surrounding blanks and a plus sign
+template <typename T>
+bool parseNumber(Field field, T &value) {
+    field = field.trimmed();
+    if (field.begin < field.end && *field.begin == '+')
+        field.begin++;
+    std::from_chars_result parsed = std::from_chars(field.begin, field.end, value);
+    return !field.empty() && parsed.ec == std::errc() && parsed.ptr == field.end;
+}
+
+bool lineError(std::size_t lineNumber, const std::string &message, std::string *errorMessage) {
+    if (errorMessage)
+        *errorMessage = "line " + std::to_string(lineNumber) + ": " + message;
+    return false;
+}
+
+template <typename T>
+void appendNumber(std::string &out, T value) {
+    char buffer[32];
+    std::to_chars_result written = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, written.ptr);
+}
+
+bool endsWith(const std::string &text, const char *suffix) {
+    std::size_t length = std::strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+// Walks the rows of the text format in file order
+class TextRows {
+public:
+    enum Row { StockRow, CutRow, NoMoreRows, BadRow };
+
+    TextRows(const char *text, std::size_t size) : position(text), begin(text), end(text + size) {
+        if (size >= 3 && std::memcmp(text, "\xEF\xBB\xBF", 3) == 0)
+            position += 3;  // UTF-8 byte order mark
+    }
+
+    // Reads up to and including the next stock or cut row
+    Row next(StockEntry &stock, CutEntry &cut, std::string *errorMessage);
+
+    double fractionRead() const { return end == begin ? 1.0 : static_cast<double>(position - begin) / (end - begin); }
+
+private:
+    const char *position;
+    const char *begin;
+    const char *end;
+    std::size_t lineNumber = 0;
+    bool loadingStock = true;
+};
+
+TextRows::Row TextRows::next(StockEntry &stock, CutEntry &cut, std::string *errorMessage) {
+    while (position < end) {
+        ++lineNumber;
+        const char *newline = static_cast<const char *>(std::memchr(position, '\n', end - position));
+        Field line{position, newline ? newline : end};
+        position = newline ? newline + 1 : end;
+        if (line.end > line.begin && line.end[-1] == '\r')
+            line.end--;
+
+        if (line.startsWith("Stock Table:")) {
+            loadingStock = true;
+            continue;
+        } else if (line.startsWith("Profile Table:")) {
+            loadingStock = false;
+            continue;
+        }
+        if (line.trimmed().empty())
+            continue;
+
+        // Name, then the two numbers; stock rows may add the price of a bar
+        Field fields[4];
+        int fieldCount = 0;
+        const char *fieldBegin = line.begin;
+        for (const char *c = line.begin;; ++c) {
+            if (c == line.end || *c == ',') {
+                if (fieldCount < 4)
+                    fields[fieldCount] = {fieldBegin, c};
+                fieldCount++;
+                fieldBegin = c + 1;
+                if (c == line.end)
+                    break;
+            }
+        }
+        if (fieldCount != 3 && !(loadingStock && fieldCount == 4)) {
+            lineError(lineNumber,
+                      std::string(loadingStock ? "expected 3 or 4" : "expected 3") + " comma separated fields, found "
+                          + std::to_string(fieldCount),
+                      errorMessage);
+            return BadRow;
+        }
+
+        if (loadingStock) {
+            stock.profileName = fields[0].text();
+            if (!parseNumber(fields[1], stock.quantity)) {
+                lineError(lineNumber, "invalid stock quantity '" + fields[1].text() + "'", errorMessage);
+                return BadRow;
+            }
+            if (!parseNumber(fields[2], stock.length)) {
+                lineError(lineNumber, "invalid stock length '" + fields[2].text() + "'", errorMessage);
+                return BadRow;
+            }
+            stock.cost = 0.0;
+            if (fieldCount == 4 && (!parseNumber(fields[3], stock.cost) || stock.cost < 0)) {
+                lineError(lineNumber, "invalid bar cost '" + fields[3].text() + "'", errorMessage);
+                return BadRow;
+            }
+            return StockRow;
+        }
+        cut.profileName = fields[0].text();
+        if (!parseNumber(fields[1], cut.lengthToCut)) {
+            lineError(lineNumber, "invalid length to cut '" + fields[1].text() + "'", errorMessage);
+            return BadRow;
+        }
+        if (!parseNumber(fields[2], cut.quantity)) {
+            lineError(lineNumber, "invalid quantity '" + fields[2].text() + "'", errorMessage);
+            return BadRow;
+        }
+        return CutRow;
+    }
+    return NoMoreRows;
+}
+
+} // namespace
+
+bool parseJobText(const char *text, std::size_t size, CuttingJob &job, std::string *errorMessage) {
+    job.stock.clear();
+    job.cuts.clear();
+
+    TextRows rows(text, size);
+    StockEntry stock;
+    CutEntry cut;
+    while (true) {
+        switch (rows.next(stock, cut, errorMessage)) {
+        case TextRows::StockRow:
+            job.stock.push_back(std::move(stock));
+            break;
+        case TextRows::CutRow:
+            job.cuts.push_back(std::move(cut));
+            break;
+        case TextRows::NoMoreRows:
+            return true;
+        case TextRows::BadRow:
+            return false;
+        }
+    }
+}
+
+bool parseJob(const char *data, std::size_t size, CuttingJob &job, std::string *errorMessage) {
+    return isBinaryJob(data, size) ? parseBinaryJob(data, size, job, errorMessage)
+                                   : parseJobText(data, size, job, errorMessage);
+}
+
+bool loadJobFile(const std::string &fileName, CuttingJob &job, std::string *errorMessage) {
+    MappedFile file;
+    if (!file.open(fileName, errorMessage))
+        return false;
+
+    bool ok = parseJob(file.data(), file.size(), job, errorMessage);
+    if (!ok && errorMessage)
+        *errorMessage = fileName + ": " + *errorMessage;
+    return ok;
+}
+
+bool saveJobFile(const std::string &fileName, const CuttingJob &job, std::string *errorMessage) {
+    if (endsWith(fileName, binaryJobExtension))
+        return writeFile(fileName, serializeJob(job), errorMessage);
+
+    // Shortest text that reads back to the same numbers
+    std::string out = "Stock Table:\n";
+    for (const auto &stock : job.stock) {
+        out += stock.profileName;
+        out += ',';
+        appendNumber(out, stock.quantity);
+        out += ',';
+        appendNumber(out, stock.length);
+        if (stock.cost > 0) {
+            out += ',';
+            appendNumber(out, stock.cost);
+        }
+        out += '\n';
+    }
+
+    out += "Profile Table:\n";
+    for (const auto &cut : job.cuts) {
+        out += cut.profileName;
+        out += ',';
+        appendNumber(out, cut.lengthToCut);
+        out += ',';
+        appendNumber(out, cut.quantity);
+        out += '\n';
+    }
+
+    return writeFile(fileName, out, errorMessage);
+}
+
+// The profile rows still to read, from either format, one row ahead
+class JobReader::Rows {
+public:
+    Rows(const char *data, std::size_t size) : data(data), textRows(data, size) { advance(); }
+    Rows(const char *data, BinaryJobTable table) : data(data), textRows(data, 0), binary(true), table(std::move(table)) {
+        advance();
+    }
+
+    bool next(CutEntry &cut) {
+        if (!hasNext)
+            return false;
+        cut = std::move(nextCut);
+        advance();
+        return true;
+    }
+
+    bool atEnd() const { return !hasNext; }
+
+    double fractionRead() const {
+        if (binary)
+            return table.cutCount == 0 ? 1.0 : static_cast<double>(row) / table.cutCount;
+        return textRows.fractionRead();
+    }
+
+private:
+    // Rows were all checked by JobReader::open, so reading them again cannot fail
+    void advance() {
+        if (binary) {
+            hasNext = row < table.cutCount && parseBinaryJobCut(data, table, row++, nextCut, nullptr);
+            return;
+        }
+        StockEntry stock;
+        TextRows::Row read;
+        while ((read = textRows.next(stock, nextCut, nullptr)) == TextRows::StockRow) {
+        }
+        hasNext = read == TextRows::CutRow;
+    }
+
+    const char *data;
+    TextRows textRows;
+    bool binary = false;
+    BinaryJobTable table;
+    std::uint32_t row = 0;
+    CutEntry nextCut;
+    bool hasNext = false;
+};
+
+JobReader::JobReader() = default;
+JobReader::~JobReader() = default;
+
+bool JobReader::open(const std::string &fileName, std::string *errorMessage) {
+    rows.reset();
+    stockRows.clear();
+    grid = LengthGrid();
+    file = std::make_unique<MappedFile>();
+    if (!file->open(fileName, errorMessage))
+        return false;
+
+    const char *data = file->data();
+    std::size_t size = file->size();
+    std::string error;
+    if (isBinaryJob(data, size)) {
+        BinaryJobTable table;
+        bool ok = parseBinaryJobStock(data, size, stockRows, table, &error);
+        CutEntry cut;
+        for (std::uint32_t row = 0; ok && row < table.cutCount; ++row) {
+            ok = parseBinaryJobCut(data, table, row, cut, &error);
+            grid.add(cut.lengthToCut);
+        }
+        if (ok)
+            rows = std::make_unique<Rows>(data, std::move(table));
+    } else {
+        // Keep the stock rows, check and skip the profile rows
+        TextRows check(data, size);
+        StockEntry stock;
+        CutEntry cut;
+        TextRows::Row read;
+        while ((read = check.next(stock, cut, &error)) != TextRows::NoMoreRows && read != TextRows::BadRow) {
+            if (read == TextRows::StockRow)
+                stockRows.push_back(stock);
+            else
+                grid.add(cut.lengthToCut);
+        }
+        if (read == TextRows::NoMoreRows)
+            rows = std::make_unique<Rows>(data, size);
+    }
+
+    for (const auto &stock : stockRows)
+        grid.add(stock.length);
+    if (!rows) {
+        stockRows.clear();
+        if (errorMessage)
+            *errorMessage = fileName + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+void JobReader::readCuts(long long pieces, std::vector<CutEntry> &cuts) {
+    CutEntry cut;
+    for (long long read = 0; rows && read < pieces && rows->next(cut);) {
+        read += cut.quantity > 0 ? cut.quantity : 0;
+        cuts.push_back(std::move(cut));
+    }
+}
+
+bool JobReader::atEnd() const {
+    return !rows || rows->atEnd();
+}
+
+double JobReader::fractionRead() const {
+    return rows ? rows->fractionRead() : 1.0;
+}
@@ -0,0 +1,79 @@
+#ifndef CUTTING_JOB_H
+#define CUTTING_JOB_H
+
+#include "length.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+// One row of the stock table: bars of a profile available at a standard length
+struct StockEntry {
+    std::string profileName;
+    int quantity = 0;
+    double length = 0.0;
+    double cost = 0.0;  // Price of one bar, 0 to price it by its length like the profile's other bars
+};
+
+// One row of the profile table: pieces of a profile that have to be cut
+struct CutEntry {
+    std::string profileName;
+    double lengthToCut = 0.0;
+    int quantity = 0;
+};
+
+// A complete cutting order, independent of any user interface
+struct CuttingJob {
+    std::vector<StockEntry> stock;
+    std::vector<CutEntry> cuts;
+};
+
+// Read and write the "Stock Table:" / "Profile Table:" text format used by the GUI.
+// Stock rows are name, quantity, length and optionally the price of one bar;
+// profile rows are name, length, quantity.
+// Files ending in .cutjob use the binary format instead; loading recognises a
+// binary job whatever its name. Errors in text files give the line number.
+bool loadJobFile(const std::string &fileName, CuttingJob &job, std::string *errorMessage = nullptr);
+bool saveJobFile(const std::string &fileName, const CuttingJob &job, std::string *errorMessage = nullptr);
+
+// Parse the text format from memory
+bool parseJobText(const char *text, std::size_t size, CuttingJob &job, std::string *errorMessage = nullptr);
+// Either format from memory, as loadJobFile does
+bool parseJob(const char *data, std::size_t size, CuttingJob &job, std::string *errorMessage = nullptr);
+
+// A job file read a part at a time, for orders too large to load whole: the
+// stock table when it is opened, then the profile table a batch of rows at a
+// time. The file is memory-mapped, so only the batch being read is copied.
+// Opening checks every row, so a bad one is reported before any is used.
+class JobReader {
+public:
+    JobReader();
+    ~JobReader();
+    JobReader(const JobReader &) = delete;
+    JobReader &operator=(const JobReader &) = delete;
+
+    bool open(const std::string &fileName, std::string *errorMessage = nullptr);
+
+    const std::vector<StockEntry> &stock() const { return stockRows; }
+    // The unit of a solve that leaves it to the job, see LengthGrid
+    double lengthUnit() const { return grid.unit(); }
+
+    // Append profile rows to `cuts` until they add up to at least `pieces`
+    // pieces or the table ends
+    void readCuts(long long pieces, std::vector<CutEntry> &cuts);
+    bool atEnd() const;
+    double fractionRead() const;  // Of the file, from 0 to 1
+
+private:
+    class Rows;
+
+    std::unique_ptr<MappedFile> file;
+    std::unique_ptr<Rows> rows;
+    std::vector<StockEntry> stockRows;
+    LengthGrid grid;
+};
+
+#endif // CUTTING_JOB_H
@@ -0,0 +1,1080 @@
+#include "cutting_solver.h"
+#include "bar_fill.h"
+#include "binary_format.h"
+#include "local_search.h"
+#include "mapped_file.h"
+#include "profile_group.h"
+#include "remnant_store.h"
+#include "result_writer.h"
+#include "solve_cache.h"
+#include "solve_stats.h"
+#include "task_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+double CuttingResult::optimizationPercent() const {
+    if (totalStockLength <= 0)
+        return 0.0;
+    return (usedStockLength / totalStockLength) * 100;
+}
+
+double CuttingResult::cutStockLength() const {
+    double length = 0.0;
+    for (const auto &scheme : schemes) {
+        if (!scheme.fromRemnant)
+            length += scheme.stockLength * scheme.count;
+    }
+    return length;
+}
+
+double CuttingResult::gapPercent() const {
+    if (stockLowerBound <= 0)
+        return 0.0;
+    return std::max(0.0, (cutStockLength() - stockLowerBound) / stockLowerBound * 100);
+}
+
+const char *solverModeName(SolverMode mode) {
+    switch (mode) {
+    case SolverMode::Greedy:
+        return "greedy";
+    case SolverMode::BestFit:
+        return "best-fit";
+    case SolverMode::ColumnGeneration:
+        return "column-generation";
+    case SolverMode::LocalSearch:
+        return "local-search";
+    }
+    return "unknown";
+}
+
+bool parseSolverMode(const std::string &name, SolverMode &mode) {
+    if (name == "greedy") {
+        mode = SolverMode::Greedy;
+    } else if (name == "best-fit" || name == "bfd") {
+        mode = SolverMode::BestFit;
+    } else if (name == "column-generation" || name == "cg") {
+        mode = SolverMode::ColumnGeneration;
+    } else if (name == "local-search" || name == "lns") {
+        mode = SolverMode::LocalSearch;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+CutPattern::Index pieceIndex(const ProfileGroup &group, Length length) {
+    auto it = std::lower_bound(group.pieceLengths.begin(), group.pieceLengths.end(), length, std::greater<Length>());
+    return static_cast<CutPattern::Index>(it - group.pieceLengths.begin());
+}
+
+void priceStock(ProfileGroup &group, const std::vector<double> &prices) {
+    group.costRate = 0.0;
+    for (std::size_t k = 0; k < group.stock.size() && group.costRate == 0.0; ++k) {
+        if (prices[k] > 0 && group.stock[k].length > 0)
+            group.costRate = prices[k] / static_cast<double>(group.stock[k].length);
+    }
+    for (std::size_t k = 0; k < group.stock.size(); ++k) {
+        StockClass &stock = group.stock[k];
+        stock.cost = stock.length;
+        if (prices[k] > 0 && group.costRate > 0)
+            stock.cost = std::max<Length>(1, std::llround(prices[k] / group.costRate));
+    }
+}
+
+Length barCost(const std::vector<StockClass> &stock, Length stockLength) {
+    for (const auto &stockClass : stock) {
+        if (stockClass.length == stockLength)
+            return stockClass.cost;
+    }
+    return stockLength;
+}
+
+namespace {
+
+// One greedy pass. Each bar gets the longest piece left that fits; the rest of
+// it is filled with the longest pieces that still fit, or with a filler, as
+// full as it can be. Bars are taken longest first or, when `cheapest`, from
+// whichever stock length cuts most for its cost, the longer on a tie.
+void greedyFill(ProfileGroup &group, std::vector<GroupScheme> &schemes, BarFiller *filler, bool cheapest) {
+    std::vector<CutPattern::Index> indices;
+    std::vector<Length> lengths;
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        indices.push_back(pieceIndex(group, lengthAndQuantity.first));
+        lengths.push_back(lengthAndQuantity.first);
+    }
+    std::vector<int> limits(lengths.size());
+    std::vector<int> pieces(lengths.size());
+    std::vector<int> candidate(lengths.size());
+
+    // Fill a bar of the given length into `counts`; false when nothing fits it
+    auto fillBar = [&](Length stockLength, std::vector<int> &counts, Length &remainder) {
+        size_t longest = 0;
+        while (longest < lengths.size()
+               && (group.lengthsToCut[longest].second <= 0 || lengths[longest] > stockLength))
+            ++longest;
+        if (longest == lengths.size())
+            return false;
+
+        remainder = stockLength - lengths[longest];
+        for (size_t i = 0; i < lengths.size(); ++i)
+            limits[i] = group.lengthsToCut[i].second;
+        --limits[longest];
+        if (filler) {
+            remainder -= filler->fill(limits, remainder, counts);
+        } else {
+            // Cut as many pieces of each length as possible, until remainder is too small
+            for (size_t i = 0; i < lengths.size(); ++i) {
+                counts[i] = 0;
+                while (counts[i] < limits[i] && remainder >= lengths[i]) {
+                    remainder -= lengths[i];
+                    counts[i]++;
+                }
+            }
+        }
+        ++counts[longest];
+        return true;
+    };
+
+    for (;;) {
+        // Nothing fits a stock length any more once it fits no piece left, so
+        // without a choice the first one that fits is the only one
+        StockClass *stock = nullptr;
+        Length remainder = 0;
+        for (auto &stockClass : group.stock) {
+            Length left;
+            if (stockClass.available <= 0 || !fillBar(stockClass.length, candidate, left))
+                continue;
+            // Lowest cost per length cut, cross-multiplied
+            if (!stock || stockClass.cost * (stock->length - remainder) < stock->cost * (stockClass.length - left)) {
+                stock = &stockClass;
+                remainder = left;
+                pieces.swap(candidate);
+            }
+            if (!cheapest)
+                break;
+        }
+        if (!stock)
+            break;
+
+        GroupScheme scheme{stock->length, CutPattern(), remainder, 0};
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            for (int c = 0; c < pieces[i]; ++c)
+                scheme.cuts.push_back(indices[i]);
+        }
+
+        // The next bar is cut exactly the same way for as long as every length
+        // in the scheme has at least as many pieces left as the bar takes
+        int copies = stock->available;
+        for (size_t i = 0; i < lengths.size(); ++i) {
+            if (pieces[i] > 0)
+                copies = std::min(copies, group.lengthsToCut[i].second / pieces[i]);
+        }
+        for (size_t i = 0; i < lengths.size(); ++i)
+            group.lengthsToCut[i].second -= pieces[i] * copies;
+
+        scheme.count = copies;
+        stock->available -= copies;
+        schemes.push_back(std::move(scheme));
+    }
+}
+
+// Pieces left uncut and cost of the stock used, for comparing plans
+std::pair<long long, Length> planCost(const ProfileGroup &group, const std::vector<GroupScheme> &schemes) {
+    long long missing = 0;
+    Length stock = 0;
+    for (const auto &lengthAndQuantity : group.lengthsToCut)
+        missing += std::max(lengthAndQuantity.second, 0);
+    for (const auto &scheme : schemes)
+        stock += barCost(group.stock, scheme.stockLength) * scheme.count;
+    return {missing, stock};
+}
+
+// The greedy fill shifts a bitset of the bar's grid cells once for every
+// length to cut, for every distinct bar it cuts. Orders with many lengths in
+// small quantities make that bars x lengths x cells / 64 word operations,
+// which would run into minutes at a few hundred thousand pieces; best fit
+// gives a plan in O(pieces log bars).
+const double maxGreedyWords = 1e9;
+
+double greedyWords(const ProfileGroup &group) {
+    double pieceLength = 0.0;
+    std::vector<Length> lengths;
+    std::vector<Length> barLengths;
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        pieceLength += static_cast<double>(lengthAndQuantity.first) * lengthAndQuantity.second;
+        lengths.push_back(lengthAndQuantity.first);
+    }
+    double bars = 0.0;
+    for (const auto &stock : group.stock) {
+        bars += stock.available;
+        barLengths.push_back(stock.length);
+    }
+    bars = std::min(bars, pieceLength / static_cast<double>(group.stock.back().length) + 1);
+    const double words = static_cast<double>(group.stock.front().length / BarFiller::gridStep(lengths, barLengths)) / 64 + 1;
+    return bars * static_cast<double>(group.lengthsToCut.size()) * words;
+}
+
+bool greedyTooSlow(const ProfileGroup &group) {
+    return greedyWords(group) > maxGreedyWords;
+}
+
+} // namespace
+
+void solveGroupGreedy(ProfileGroup &group, std::vector<GroupScheme> &schemes) {
+    std::vector<Length> lengths;
+    std::vector<Length> barLengths;
+    for (const auto &lengthAndQuantity : group.lengthsToCut)
+        lengths.push_back(lengthAndQuantity.first);
+    for (const auto &stock : group.stock)
+        barLengths.push_back(stock.length);
+    BarFiller filler(lengths, barLengths);
+
+    // With several stock lengths, also the exact fill that picks each bar for
+    // its cost, so short demand is not cut from long or dear bars. It fills a
+    // bar of every length for each bar it cuts, so only where that is affordable.
+    const bool byCost = group.stock.size() > 1
+                        && greedyWords(group) * static_cast<double>(group.stock.size()) <= maxGreedyWords;
+    ProfileGroup cheap = byCost ? group : ProfileGroup();
+
+    // Both ways. Full bars are what the exact fill is for, but taking the
+    // easy combinations first can leave awkward pieces for the last bars,
+    // which the plain fill sometimes avoids; ties go to the plain fill.
+    ProfileGroup exact = group;
+    std::vector<GroupScheme> exactSchemes;
+    greedyFill(exact, exactSchemes, &filler, false);
+    std::vector<GroupScheme> plainSchemes;
+    greedyFill(group, plainSchemes, nullptr, false);
+
+    if (planCost(exact, exactSchemes) < planCost(group, plainSchemes)) {
+        group = std::move(exact);
+        plainSchemes = std::move(exactSchemes);
+    }
+
+    // Picking bar by bar can strand long pieces for later, so the fill by cost
+    // has to win outright
+    if (byCost) {
+        std::vector<GroupScheme> cheapSchemes;
+        greedyFill(cheap, cheapSchemes, &filler, true);
+        if (planCost(cheap, cheapSchemes) < planCost(group, plainSchemes)) {
+            group = std::move(cheap);
+            plainSchemes = std::move(cheapSchemes);
+        }
+    }
+    for (auto &scheme : plainSchemes)
+        schemes.push_back(std::move(scheme));
+}
+
+StopCondition::StopCondition(const SolverOptions &options)
+    : cancelled(options.cancelled), hasDeadline(options.timeLimit > 0) {
+    if (hasDeadline) {
+        deadline = std::chrono::steady_clock::now()
+                   + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimit));
+    }
+}
+
+bool StopCondition::shouldStop() const {
+    if (cancelled && cancelled->load(std::memory_order_relaxed))
+        return true;
+    return hasDeadline && std::chrono::steady_clock::now() >= deadline;
+}
+
+namespace {
+
+// `stock` is the group's stock before the solve, which prices the bars: column
+// generation drops the stock lengths it uses up
+GroupPlan makeGroupPlan(const ProfileGroup &group, const std::vector<StockClass> &stock, std::vector<GroupScheme> schemes) {
+    GroupPlan plan;
+    for (const auto &scheme : schemes)
+        plan.stockUsed += barCost(stock, scheme.stockLength) * scheme.count;
+    plan.schemes = std::move(schemes);
+
+    // Check if any profiles remain uncut
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        if (lengthAndQuantity.second > 0) {
+            plan.uncut.push_back(lengthAndQuantity);
+            plan.missingPieces += lengthAndQuantity.second;
+        }
+    }
+    return plan;
+}
+
+int barCount(const std::vector<GroupScheme> &schemes) {
+    int bars = 0;
+    for (const auto &scheme : schemes)
+        bars += scheme.count;
+    return bars;
+}
+
+// Cover more of the order first, then use less stock
+bool isBetterPlan(const GroupPlan &plan, const GroupPlan &than) {
+    if (plan.missingPieces != than.missingPieces)
+        return plan.missingPieces < than.missingPieces;
+    return plan.stockUsed < than.stockUsed;
+}
+
+// Take over the bars of an earlier plan of the group, as far as its stock and
+// demand still allow, so that a small edit changes little of the plan.
+// `previousLengths` are the piece lengths the earlier patterns index. Consumes
+// quantities and bars like solveGroupGreedy.
+void keepPreviousBars(ProfileGroup &group, const std::vector<Length> &previousLengths,
+                      const std::vector<GroupScheme> &previous, std::vector<GroupScheme> &schemes) {
+    std::vector<int> left(group.pieceLengths.size(), 0);
+    std::vector<int> taken(group.pieceLengths.size(), 0);
+    for (const auto &lengthAndQuantity : group.lengthsToCut)
+        left[pieceIndex(group, lengthAndQuantity.first)] += lengthAndQuantity.second;
+
+    for (const GroupScheme &scheme : previous) {
+        auto stock = std::find_if(group.stock.begin(), group.stock.end(),
+                                  [&](const StockClass &stockClass) { return stockClass.length == scheme.stockLength; });
+        if (stock == group.stock.end() || stock->available == 0 || scheme.cuts.empty())
+            continue;
+
+        // Patterns are sorted, so equal cuts are next to each other
+        GroupScheme kept{scheme.stockLength, CutPattern(), scheme.remainder, std::min(scheme.count, stock->available)};
+        for (const CutPattern::Index *cut = scheme.cuts.begin(); cut != scheme.cuts.end() && kept.count > 0;) {
+            const CutPattern::Index *run = cut;
+            while (run != scheme.cuts.end() && *run == *cut)
+                ++run;
+            const Length length = previousLengths[*cut];
+            auto it = std::lower_bound(group.pieceLengths.begin(), group.pieceLengths.end(), length, std::greater<Length>());
+            if (it == group.pieceLengths.end() || *it != length) {
+                kept.count = 0;
+                break;
+            }
+            const CutPattern::Index index = static_cast<CutPattern::Index>(it - group.pieceLengths.begin());
+            kept.count = std::min(kept.count, left[index] / static_cast<int>(run - cut));
+            for (; cut != run; ++cut)
+                kept.cuts.push_back(index);
+        }
+        if (kept.count <= 0)
+            continue;
+
+        for (CutPattern::Index index : kept.cuts) {
+            left[index] -= kept.count;
+            taken[index] += kept.count;
+        }
+        stock->available -= kept.count;
+        schemes.push_back(std::move(kept));
+    }
+
+    for (auto &lengthAndQuantity : group.lengthsToCut) {
+        int &pieces = taken[pieceIndex(group, lengthAndQuantity.first)];
+        const int cut = std::min(lengthAndQuantity.second, pieces);
+        lengthAndQuantity.second -= cut;
+        pieces -= cut;
+    }
+}
+
+// The lengths one group's job rows gave, for its report
+struct GroupLengths {
+    explicit GroupLengths(const LengthUnit &unit) : stock(unit), pieces(unit), offcuts(unit) {}
+
+    JobLengths stock;
+    JobLengths pieces;
+    JobLengths offcuts;
+};
+
+// Back to job lengths, for reporting. Identical bars are counted on their
+// patterns; each distinct scheme is expanded into CuttingSchemes only once,
+// with the lengths the job gave for its bars and pieces. The offcuts each
+// group cuts come first.
+CuttingResult combinePlans(const std::vector<ProfileGroup> &groups, const std::vector<GroupPlan> &plans,
+                           const std::vector<std::vector<GroupScheme>> &remnantSchemes,
+                           const std::vector<GroupLengths> &jobLengths, const LengthUnit &unit,
+                           double totalStockLength) {
+    CuttingResult result;
+    result.totalStockLength = totalStockLength;
+    Length stockLowerBound = 0;
+
+    for (size_t g = 0; g < plans.size(); ++g) {
+        const ProfileGroup &group = groups[g];
+        if (group.costRate > 0) {
+            stockLowerBound += group.lengthLowerBound;
+            result.stockCost += static_cast<double>(plans[g].stockUsed) * group.costRate;
+            result.stockCostLowerBound += static_cast<double>(group.stockLowerBound) * group.costRate;
+        } else {
+            stockLowerBound += group.stockLowerBound;
+        }
+
+        GroupLengths lengths = jobLengths[g];
+        std::vector<Length> cuts;
+        auto report = [&](const std::vector<GroupScheme> &groupSchemes, bool fromRemnant) {
+            SchemeCounter counter;
+            for (const auto &scheme : groupSchemes)
+                counter.add(scheme);
+
+            // Longest stock first, then longest cuts first
+            std::vector<GroupScheme> &schemes = counter.schemes();
+            std::sort(schemes.begin(), schemes.end(), [](const GroupScheme &a, const GroupScheme &b) {
+                if (a.stockLength != b.stockLength)
+                    return a.stockLength > b.stockLength;
+                return a.cuts < b.cuts;
+            });
+
+            for (const auto &groupScheme : schemes) {
+                cuts.clear();
+                for (CutPattern::Index index : groupScheme.cuts)
+                    cuts.push_back(group.pieceLengths[index]);
+                handOutBars(fromRemnant ? lengths.offcuts : lengths.stock, lengths.pieces, groupScheme.stockLength, cuts,
+                            groupScheme.count, [&](double stockLength, const std::vector<double> &jobCuts, int count) {
+                                CuttingScheme scheme;
+                                scheme.profileName = group.profileName;
+                                scheme.stockLength = stockLength;
+                                scheme.cuts = jobCuts;
+                                scheme.count = count;
+                                scheme.fromRemnant = fromRemnant;
+                                for (double cut : jobCuts) {
+                                    stockLength -= cut;
+                                    result.usedStockLength += cut * count;
+                                }
+                                scheme.remainder = std::max(0.0, stockLength);
+                                result.schemes.push_back(std::move(scheme));
+                            });
+            }
+        };
+        report(remnantSchemes[g], true);
+        report(plans[g].schemes, false);
+
+        if (plans[g].noStock)
+            result.shortages.push_back({group.profileName, 0.0, 0, true});
+        for (const auto &lengthAndQuantity : plans[g].uncut)
+            handOutPieces(lengths.pieces, lengthAndQuantity.first, lengthAndQuantity.second, [&](double length, int quantity) {
+                result.shortages.push_back({group.profileName, length, quantity, false});
+            });
+    }
+    result.stockLowerBound = unit.toJob(stockLowerBound);
+
+    return result;
+}
+
+// Local search works in rounds of this many moves per search
+const int movesPerRound = 1000;
+const unsigned maxSearchStarts = 255;  // The search number has to fit in 8 bits
+
+// The unit of a solve that leaves it to the job, see LengthGrid. Offcuts do not
+// count; any that are off the grid are rounded down to it.
+double jobLengthUnit(const CuttingJob &job) {
+    LengthGrid grid;
+    for (const auto &stock : job.stock)
+        grid.add(stock.length);
+    for (const auto &cut : job.cuts)
+        grid.add(cut.lengthToCut);
+    return grid.unit();
+}
+
+// Plans in a cache or checkpoint only count for a solve with the settings
+// they were found with
+bool sameSettings(const SolveCache::State &state, const SolverOptions &options, const LengthUnit &unit, unsigned searchStarts) {
+    return state.mode == options.mode && state.lengthUnit == unit.size() && state.seed == options.seed
+           && state.searchStarts == searchStarts && state.searchMoves == options.searchMoves
+           && state.remnants == (options.remnants != nullptr);
+}
+
+void setSettings(SolveCache::State &state, const SolverOptions &options, const LengthUnit &unit, unsigned searchStarts) {
+    state.mode = options.mode;
+    state.lengthUnit = unit.size();
+    state.seed = options.seed;
+    state.searchStarts = searchStarts;
+    state.searchMoves = options.searchMoves;
+    state.remnants = options.remnants != nullptr;
+}
+
+} // namespace
+
+SolveCache::SolveCache() : state(new State) {}
+
+SolveCache::~SolveCache() = default;
+
+void SolveCache::clear() {
+    state->groups.clear();
+}
+
+bool SolveCache::save(const std::string &fileName, std::string *errorMessage) const {
+    return replaceFile(fileName, serializeCheckpoint(*state), errorMessage);
+}
+
+bool SolveCache::load(const std::string &fileName, std::string *errorMessage) {
+    MappedFile file;
+    if (!file.open(fileName, errorMessage))
+        return false;
+    State loaded;
+    if (!parseCheckpoint(file.data(), file.size(), loaded, errorMessage)) {
+        if (errorMessage)
+            *errorMessage = fileName + ": " + *errorMessage;
+        return false;
+    }
+    *state = std::move(loaded);
+    return true;
+}
+
+CuttingResult solveCuttingJob(const CuttingJob &job, const SolverOptions &options) {
+    const StopCondition stop(options);
+    const LengthUnit unit(options.lengthUnit > 0 ? options.lengthUnit : jobLengthUnit(job));
+    std::map<std::string, ProfileGroup> groupsByName;
+    std::map<std::string, GroupLengths> lengthsByName;
+    double totalStockLength = 0.0;
+    TaskPool pool(options.threads);
+    const unsigned searchStarts = std::min(options.searchStarts > 0 ? options.searchStarts : pool.threadCount(), maxSearchStarts);
+
+    // Plans found with other settings are no start for this solve
+    SolveCache::State *cache = options.cache ? options.cache->state.get() : nullptr;
+    if (cache && !sameSettings(*cache, options, unit, searchStarts)) {
+        cache->groups.clear();
+        setSettings(*cache, options, unit, searchStarts);
+    }
+    const bool checkpointing = !options.checkpointFile.empty();
+
+    // Group stock profiles by type and length. Only the bar count of each
+    // distinct length is kept, however many bars the inventory holds, with
+    // the average price of the rows that price their bars.
+    PhaseTimer groupingTimer(options.stats, "grouping");
+    struct Bars {
+        int count = 0;
+        int priced = 0;
+        double price = 0.0;  // Of the priced bars together
+    };
+    std::map<std::string, std::map<Length, Bars, std::greater<Length>>> stockByProfile;
+    for (const auto &stock : job.stock) {
+        if (stock.quantity <= 0)
+            continue;
+        Length length = unit.barFromJob(stock.length);
+        lengthsByName.emplace(stock.profileName, GroupLengths(unit)).first->second.stock.add(length, stock.length, stock.quantity);
+        Bars &bars = stockByProfile[stock.profileName][length];
+        bars.count += stock.quantity;
+        if (stock.cost > 0) {
+            bars.priced += stock.quantity;
+            bars.price += stock.cost * stock.quantity;
+        }
+        totalStockLength += stock.length * stock.quantity;
+    }
+
+    // Group profiles by name
+    for (const auto &cut : job.cuts) {
+        Length length = unit.pieceFromJob(cut.lengthToCut);
+        groupsByName[cut.profileName].lengthsToCut.emplace_back(length, cut.quantity);
+        lengthsByName.emplace(cut.profileName, GroupLengths(unit)).first->second.pieces.add(length, cut.lengthToCut, cut.quantity);
+    }
+
+    // Offcuts are cut first, and what they leave is the demand the solvers see.
+    // A group the cache has seen exactly like this keeps its plan.
+    std::vector<ProfileGroup> groups;
+    std::vector<GroupLengths> jobLengths;
+    std::vector<std::vector<GroupScheme>> remnantSchemes;
+    std::vector<SolveCache::State::Group> inputs;    // Only with a cache or checkpoints
+    std::vector<const SolveCache::State::Group *> previous;
+    std::vector<char> unchanged;  // The cache has seen the group exactly like this
+    std::vector<char> reused;     // ... and solved it to the end
+    for (auto &entry : groupsByName) {
+        ProfileGroup &group = entry.second;
+        group.profileName = entry.first;
+        if (group.lengthsToCut.empty())
+            continue;
+
+        // Longest stock and longest cuts first
+        std::vector<double> prices;
+        for (const auto &lengthAndBars : stockByProfile[group.profileName]) {
+            const Bars &bars = lengthAndBars.second;
+            group.stock.push_back({lengthAndBars.first, bars.count, lengthAndBars.first});
+            prices.push_back(bars.priced > 0 ? bars.price / bars.priced : 0.0);
+        }
+        priceStock(group, prices);
+        std::sort(group.lengthsToCut.begin(), group.lengthsToCut.end(), std::greater<>());
+        for (const auto &lengthAndQuantity : group.lengthsToCut) {
+            if (group.pieceLengths.empty() || group.pieceLengths.back() != lengthAndQuantity.first)
+                group.pieceLengths.push_back(lengthAndQuantity.first);
+        }
+        GroupLengths &lengths = lengthsByName.at(group.profileName);
+        std::vector<Length> remnants;
+        if (options.remnants) {
+            for (auto it = options.remnants->begin(group.profileName); it != options.remnants->end(group.profileName); ++it) {
+                remnants.push_back(unit.barFromJob(*it));
+                lengths.offcuts.add(remnants.back(), *it, 1);
+                totalStockLength += *it;
+            }
+        }
+
+        const SolveCache::State::Group *cached = nullptr;
+        bool same = false;
+        if (cache) {
+            auto it = cache->groups.find(group.profileName);
+            if (it != cache->groups.end()) {
+                cached = &it->second;
+                same = cached->lengthsToCut == group.lengthsToCut && cached->remnants == remnants
+                       && std::equal(cached->stock.begin(), cached->stock.end(), group.stock.begin(), group.stock.end(),
+                                     [](const StockClass &a, const StockClass &b) {
+                                         return a.length == b.length && a.available == b.available && a.cost == b.cost;
+                                     });
+            }
+        }
+        if (cache || checkpointing) {
+            SolveCache::State::Group input;
+            input.stock = group.stock;
+            input.lengthsToCut = group.lengthsToCut;
+            input.remnants = remnants;
+            input.pieceLengths = group.pieceLengths;
+            inputs.push_back(std::move(input));
+        }
+        previous.push_back(cached);
+        unchanged.push_back(same);
+        reused.push_back(same && cached->final);
+
+        std::vector<GroupScheme> schemes;
+        if (!remnants.empty())
+            solveGroupRemnants(group, remnants, schemes);
+        remnantSchemes.push_back(std::move(schemes));
+        group.stockLowerBound = same ? cached->stockLowerBound : stockLowerBound(group);
+        if (group.costRate > 0)
+            group.lengthLowerBound = stockLengthLowerBound(group);
+        groups.push_back(std::move(group));
+        jobLengths.push_back(std::move(lengths));
+    }
+    groupingTimer.stop();
+
+    // Every group is its own task. The ones with most distinct lengths go first
+    // so that one large group does not start last and hold up the whole solve.
+    std::vector<size_t> order(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g)
+        order[g] = g;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return groups[a].lengthsToCut.size() * groups[a].stock.size()
+               > groups[b].lengthsToCut.size() * groups[b].stock.size();
+    });
+
+    // Plans and bounds are written and the callbacks run under this lock, so
+    // callers see them one at a time whatever the number of threads
+    std::mutex planMutex;
+    const int searchRounds = options.mode == SolverMode::LocalSearch && options.searchMoves > 0
+                                 ? (options.searchMoves + movesPerRound - 1) / movesPerRound
+                                 : 0;
+    const size_t steps = options.mode == SolverMode::ColumnGeneration ? 2 * groups.size() : groups.size() + searchRounds;
+    size_t step = 0;
+    auto reportProgress = [&](size_t done = 1) {
+        step += done;
+        if (options.onProgress)
+            options.onProgress(static_cast<double>(step) / steps);
+    };
+
+    // A plan that cuts everything from no more than the lower bound of stock
+    // cannot be improved on
+    std::vector<GroupPlan> plans(groups.size());
+    auto combine = [&]() {
+        PhaseTimer timer(options.stats, "dedupe");
+        CuttingResult result = combinePlans(groups, plans, remnantSchemes, jobLengths, unit, totalStockLength);
+        if (options.remnants)
+            options.remnants->identifyOffcuts(result);
+        return result;
+    };
+    auto provenOptimal = [&](size_t g) {
+        return plans[g].missingPieces == 0 && plans[g].stockUsed <= groups[g].stockLowerBound;
+    };
+
+    // Where the solve of each group stands, for the cache and for checkpoints:
+    // whether it is done, and the pattern pool and searches of one that is not
+    std::vector<char> done(groups.size(), 0);
+    std::vector<std::vector<GroupScheme>> patterns(groups.size());
+    std::vector<std::vector<GroupSearch>> searches(groups.size());
+    std::vector<int> searchRound(groups.size(), 0);  // Rounds the searches have made
+    for (size_t g = 0; g < groups.size(); ++g) {
+        if (unchanged[g] && !reused[g])
+            patterns[g] = previous[g]->patterns;
+    }
+    std::atomic<bool> stoppedEarly{false};
+
+    // Every group as it stands. The last snapshot, the one the cache keeps,
+    // takes the plans over.
+    auto snapshot = [&](SolveCache::State &state, bool last) {
+        setSettings(state, options, unit, searchStarts);
+        state.groups.clear();
+        for (size_t g = 0; g < groups.size(); ++g) {
+            SolveCache::State::Group entry = last ? std::move(inputs[g]) : inputs[g];
+            entry.stockLowerBound = groups[g].stockLowerBound;
+            entry.plan = last ? std::move(plans[g]) : plans[g];
+            entry.final = done[g] || (last && !stoppedEarly);
+            if (!entry.final) {
+                entry.patterns = patterns[g];
+                entry.searchRounds = searchRound[g];
+                for (const GroupSearch &search : searches[g]) {
+                    SolveCache::State::Search saved;
+                    saved.random = search.randomState();
+                    search.saveBars(saved.bars);
+                    entry.searches.push_back(std::move(saved));
+                }
+            }
+            state.groups.emplace(groups[g].profileName, std::move(entry));
+        }
+    };
+
+    // Taken where plans are published, under the same lock, once the interval
+    // has passed. A long LP or round can make it later.
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    auto checkpoint = [&]() {
+        if (!checkpointing
+            || std::chrono::steady_clock::now() - lastCheckpoint < std::chrono::duration<double>(options.checkpointInterval))
+            return;
+        PhaseTimer timer(options.stats, "checkpoint");
+        SolveCache::State state;
+        snapshot(state, false);
+        replaceFile(options.checkpointFile, serializeCheckpoint(state), nullptr);
+        lastCheckpoint = std::chrono::steady_clock::now();
+    };
+
+    // The greedy fill is the first complete plan. It is cheap and always runs to
+    // the end, so even a cancelled solve returns something usable.
+    auto firstPlan = [&](ProfileGroup &group, std::vector<GroupScheme> &schemes) {
+        if (options.mode == SolverMode::BestFit || greedyTooSlow(group))
+            solveGroupBestFit(group, schemes);
+        else
+            solveGroupGreedy(group, schemes);
+    };
+    pool.run(order, [&](size_t g) {
+        PhaseTimer timer(options.stats, "solve: fill", groups[g].profileName.c_str());
+        GroupPlan plan;
+        if (reused[g]) {
+            plan = previous[g]->plan;
+            if (options.stats)
+                options.stats->add(SolveStats::GroupsReused);
+        } else if (groups[g].stock.empty()) {
+            plan.noStock = std::any_of(groups[g].lengthsToCut.begin(), groups[g].lengthsToCut.end(),
+                                       [](const std::pair<Length, int> &lengthAndQuantity) { return lengthAndQuantity.second > 0; });
+        } else {
+            ProfileGroup group = groups[g];
+            std::vector<GroupScheme> schemes;
+            firstPlan(group, schemes);
+            plan = makeGroupPlan(group, groups[g].stock, std::move(schemes));
+
+            // After an edit, the old bars that still fit with the rest filled in
+            // beside them. It wins ties: the operator sees fewer bars change.
+            if (previous[g]) {
+                ProfileGroup kept = groups[g];
+                std::vector<GroupScheme> keptSchemes;
+                keepPreviousBars(kept, previous[g]->pieceLengths, previous[g]->plan.schemes, keptSchemes);
+                firstPlan(kept, keptSchemes);
+                GroupPlan keptPlan = makeGroupPlan(kept, groups[g].stock, std::move(keptSchemes));
+                if (!isBetterPlan(plan, keptPlan))
+                    plan = std::move(keptPlan);
+            }
+            if (options.stats)
+                options.stats->add(SolveStats::BarsOpened, barCount(plan.schemes));
+        }
+
+        std::lock_guard<std::mutex> lock(planMutex);
+        plans[g] = std::move(plan);
+        done[g] = reused[g] || groups[g].stock.empty() || options.mode == SolverMode::Greedy
+                  || options.mode == SolverMode::BestFit;
+        reportProgress();
+        checkpoint();
+    });
+
+    if (options.mode != SolverMode::Greedy && options.onIncumbent)
+        options.onIncumbent(combine());
+
+    if (options.mode == SolverMode::ColumnGeneration) {
+        // Improve the groups and publish every plan that beats the incumbent.
+        // A greedy plan that is optimal already, the usual case in production,
+        // is left alone, and so is a group too large for the LP.
+        pool.run(order, [&](size_t g) {
+            const bool complete = !groups[g].stock.empty() && plans[g].missingPieces == 0;
+            if (reused[g] || (complete && provenOptimal(g)) || groups[g].pieceLengths.size() > maxColumnGenerationLengths) {
+                std::lock_guard<std::mutex> lock(planMutex);
+                done[g] = true;
+                reportProgress();
+                return;
+            }
+            if (stop.shouldStop()) {
+                std::lock_guard<std::mutex> lock(planMutex);
+                stoppedEarly = true;
+                done[g] = true;
+                reportProgress();
+                return;
+            }
+
+            PhaseTimer timer(options.stats, "solve: column generation", groups[g].profileName.c_str());
+            GroupPlan plan;
+            bool solved = false;
+            bool stopped = false;
+            ProfileGroup group = groups[g];
+            std::vector<GroupScheme> patternPool = patterns[g];
+            if (!group.stock.empty()) {
+                std::vector<GroupScheme> schemes;
+                solved = solveGroupColumnGeneration(group, schemes, stop, complete ? plans[g].stockUsed : 0, options.stats,
+                                                    &patternPool);
+                stopped = stop.shouldStop();
+                if (stopped)
+                    stoppedEarly = true;
+                if (solved) {
+                    plan = makeGroupPlan(group, groups[g].stock, std::move(schemes));
+                    if (options.stats)
+                        options.stats->add(SolveStats::BarsOpened, barCount(plan.schemes));
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(planMutex);
+            groups[g].stockLowerBound = group.stockLowerBound;
+            patterns[g] = std::move(patternPool);
+            done[g] = !stopped;
+            if (solved && isBetterPlan(plan, plans[g])) {
+                plans[g] = std::move(plan);
+                if (options.onIncumbent)
+                    options.onIncumbent(combine());
+            }
+            reportProgress();
+            checkpoint();
+        });
+    }
+
+    if (searchRounds > 0) {
+        // Every group that may still improve gets the same number of searches,
+        // each with its own random stream. Search 0 carries on from the greedy
+        // plan, the others build their own first plan. Searches an earlier solve
+        // of the group left between two rounds carry on from there instead, and
+        // skip the rounds they have made.
+        std::vector<size_t> open;
+        for (size_t g : order) {
+            if (reused[g] || groups[g].stock.empty() || provenOptimal(g)) {
+                done[g] = true;
+                continue;
+            }
+            open.push_back(g);
+            searches[g].reserve(searchStarts);
+            for (unsigned s = 0; s < searchStarts; ++s)
+                searches[g].emplace_back(groups[g], options.seed, (static_cast<std::uint64_t>(g) << 8) | s);
+            if (unchanged[g] && previous[g]->searchRounds > 0 && previous[g]->searches.size() == searchStarts) {
+                for (unsigned s = 0; s < searchStarts; ++s)
+                    searches[g][s].resume(previous[g]->searches[s].bars, previous[g]->searches[s].random);
+                searchRound[g] = std::min(previous[g]->searchRounds, searchRounds);
+            }
+        }
+
+        // The best complete plan of each group as stock << 8 | search, so that a
+        // search can see without locking that one before it has reached the
+        // lower bound, and give up: it could not be chosen any more
+        const std::uint64_t noPlan = ~std::uint64_t(0);
+        std::vector<std::atomic<std::uint64_t>> bestComplete(groups.size());
+        for (auto &slot : bestComplete)
+            slot.store(noPlan, std::memory_order_relaxed);
+
+        auto isBetterSearch = [](const GroupSearch &search, const GroupSearch &than) {
+            if (search.missingPieces() != than.missingPieces())
+                return search.missingPieces() < than.missingPieces();
+            return search.stockUsed() < than.stockUsed();
+        };
+
+        // Searches run in rounds of a fixed number of moves and only meet between
+        // rounds, in a fixed order, so timing never changes the plan. A solve
+        // resumed from a checkpoint taken between rounds ends with the plan the
+        // uninterrupted one would have.
+        int round = open.empty() ? 0 : searchRounds;
+        for (size_t g : open)
+            round = std::min(round, searchRound[g]);
+        reportProgress(round);
+        for (; round < searchRounds && !open.empty(); ++round) {
+            if (stop.shouldStop()) {
+                stoppedEarly = true;
+                break;
+            }
+
+            std::vector<std::pair<size_t, unsigned>> tasks;
+            for (size_t g : open) {
+                for (unsigned s = 0; s < searchStarts && searchRound[g] == round; ++s)
+                    tasks.emplace_back(g, s);
+            }
+            std::vector<size_t> taskOrder(tasks.size());
+            for (size_t t = 0; t < tasks.size(); ++t)
+                taskOrder[t] = t;
+            const int moves = std::min(movesPerRound, options.searchMoves - round * movesPerRound);
+
+            pool.run(taskOrder, [&](size_t t) {
+                const size_t g = tasks[t].first;
+                const unsigned s = tasks[t].second;
+                PhaseTimer timer(options.stats, "solve: local search", groups[g].profileName.c_str());
+                GroupSearch &search = searches[g][s];
+                if (round == 0) {
+                    if (s == 0)
+                        search.startFrom(plans[g].schemes);
+                    else
+                        search.construct();
+                }
+
+                const Length bound = groups[g].stockLowerBound;
+                auto finished = [&]() {
+                    if (search.missingPieces() == 0 && search.stockUsed() <= bound) {
+                        const std::uint64_t key = static_cast<std::uint64_t>(search.stockUsed()) << 8 | s;
+                        std::uint64_t best = bestComplete[g].load(std::memory_order_relaxed);
+                        while (key < best && !bestComplete[g].compare_exchange_weak(best, key, std::memory_order_relaxed)) {
+                        }
+                        return true;
+                    }
+                    const std::uint64_t best = bestComplete[g].load(std::memory_order_relaxed);
+                    if (best != noPlan && (best & 0xff) < s)
+                        return true;
+                    return stop.shouldStop();
+                };
+                const int made = search.improve(moves, finished);
+                if (options.stats)
+                    options.stats->add(SolveStats::ImprovementIterations, made);
+            });
+            if (stop.shouldStop())
+                stoppedEarly = true;
+
+            std::lock_guard<std::mutex> lock(planMutex);
+            bool improved = false;
+            std::vector<size_t> stillOpen;
+            for (size_t g : open) {
+                if (searchRound[g] > round) {
+                    stillOpen.push_back(g);
+                    continue;
+                }
+                ++searchRound[g];
+
+                // Ties go to the first search, again so that timing does not matter
+                const GroupSearch *best = &searches[g][0];
+                for (const GroupSearch &search : searches[g]) {
+                    if (isBetterSearch(search, *best))
+                        best = &search;
+                }
+
+                ProfileGroup group = groups[g];
+                std::vector<GroupScheme> schemes;
+                best->takePlan(group, schemes);
+                GroupPlan plan = makeGroupPlan(group, groups[g].stock, std::move(schemes));
+                if (isBetterPlan(plan, plans[g])) {
+                    plans[g] = std::move(plan);
+                    improved = true;
+                }
+                if (provenOptimal(g)) {
+                    done[g] = true;
+                    continue;
+                }
+
+                // The searches that fell behind start over from the best plan
+                stillOpen.push_back(g);
+                for (GroupSearch &search : searches[g]) {
+                    if (isBetterSearch(*best, search))
+                        search.copyPlan(*best);
+                }
+            }
+            open.swap(stillOpen);
+
+            if (improved && options.onIncumbent)
+                options.onIncumbent(combine());
+            reportProgress();
+            checkpoint();
+        }
+        reportProgress(searchRounds - round);
+
+        if (options.stats) {
+            for (size_t g : order) {
+                for (const GroupSearch &search : searches[g])
+                    options.stats->add(SolveStats::BarsOpened, search.barsOpened());
+            }
+        }
+    }
+
+    CuttingResult result = combine();
+    result.stoppedEarly = stoppedEarly;
+
+    // Profiles that are not in this job any more are dropped. The last
+    // checkpoint is what the cache now holds, so resuming from it after this
+    // solve is the same as solving again with the cache.
+    if (cache || checkpointing) {
+        SolveCache::State last;
+        SolveCache::State &state = cache ? *cache : last;
+        snapshot(state, true);
+        if (checkpointing) {
+            PhaseTimer timer(options.stats, "checkpoint");
+            replaceFile(options.checkpointFile, serializeCheckpoint(state), nullptr);
+        }
+    }
+    return result;
+}
+
+// Same output as QString::number(double): %g with 6 significant digits
+std::string formatLength(double length) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", length);
+    return buffer;
+}
+
+std::string formatScheme(const CuttingScheme &scheme) {
+    std::string text;
+    for (std::size_t i = 0; i < scheme.cuts.size(); ++i) {
+        if (i > 0)
+            text += " + ";
+        text += formatLength(scheme.cuts[i]);
+    }
+    text += (scheme.fromRemnant ? " from offcut of profile " : " from stock profile ") + scheme.profileName
+            + ", remainder: " + formatLength(scheme.remainder);
+    return text;
+}
+
+std::string formatShortage(const Shortage &shortage) {
+    if (shortage.noStock)
+        return "No stock available for profile: " + shortage.profileName;
+    return "Not enough stock for " + shortage.profileName + " (Need " + std::to_string(shortage.quantity)
+           + " more pieces of length " + formatLength(shortage.lengthToCut) + ")";
+}
+
+std::string formatResultSummary(const CuttingResult &result) {
+    std::string text;
+    if (result.stoppedEarly)
+        text += "\nStopped early, showing the best plan found so far\n";
+
+    char percent[64];
+    std::snprintf(percent, sizeof(percent), "\nOptimization Percentage: %.2f%%\n", result.optimizationPercent());
+    text += percent;
+
+    // Priced stock is what the solver saves on, so its gap comes first
+    if (result.stockCost > 0) {
+        std::snprintf(percent, sizeof(percent), "Stock Cost: %.2f\n", result.stockCost);
+        text += percent;
+        if (result.shortages.empty() && result.stockCostLowerBound > 0) {
+            double gap = std::max(0.0, (result.stockCost - result.stockCostLowerBound) / result.stockCostLowerBound * 100);
+            // The bound prices the stock each length has, but mostly not which pieces fit
+            // which bars, so a plan on mixed lengths can be closer to optimal than it shows
+            std::snprintf(percent, sizeof(percent), "Gap to cost lower bound: %.2f%% (at most)\n", gap);
+            text += percent;
+        }
+    }
+
+    // The bound assumes every piece is cut, so a plan with shortages has no gap to show
+    if (result.shortages.empty() && result.stockLowerBound > 0) {
+        double gap = result.gapPercent();
+        if (gap < 0.005)
+            std::snprintf(percent, sizeof(percent), "Gap to lower bound: 0.00%% (proven optimal)\n");
+        else
+            std::snprintf(percent, sizeof(percent), "Gap to lower bound: %.2f%%\n", gap);
+        text += percent;
+    }
+
+    return text;
+}
+
+std::string formatCuttingResult(const CuttingResult &result) {
+    std::string text;
+    ReportSink sink([&text](const char *data, std::size_t size) { text.append(data, size); });
+    writeCuttingResult(result, sink);
+    return text;
+}
+
+bool saveResultFile(const std::string &fileName, const CuttingResult &result, std::string *errorMessage) {
+    return saveResultFile(fileName, result, resultFormatOf(fileName), errorMessage);
+}
+
+bool loadResultFile(const std::string &fileName, CuttingResult &result, std::string *errorMessage) {
+    MappedFile file;
+    if (!file.open(fileName, errorMessage))
+        return false;
+    if (!parseBinaryResult(file.data(), file.size(), result, errorMessage)) {
+        if (errorMessage)
+            *errorMessage = fileName + ": " + *errorMessage;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,170 @@
+#ifndef CUTTING_SOLVER_H
+#define CUTTING_SOLVER_H
+
+#include "cutting_job.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A way of cutting one stock bar, and how many bars are cut exactly like it
+struct CuttingScheme {
+    std::string profileName;
+    double stockLength = 0.0;
+    std::vector<double> cuts;   // Lengths cut from the bar, in cutting order
+    double remainder = 0.0;
+    int count = 0;
+    bool fromRemnant = false;   // Cut from an offcut of an earlier job, not from new stock
+    // Which offcuts: their positions in the store's list of the profile, one
+    // per bar, see RemnantStore::identifyOffcuts. Not kept in result files.
+    std::vector<std::size_t> offcuts;
+};
+
+// Demand that could not be covered by the available stock
+struct Shortage {
+    std::string profileName;
+    double lengthToCut = 0.0;
+    int quantity = 0;
+    bool noStock = false;       // The profile has no stock rows at all
+};
+
+enum class SolverMode {
+    Greedy,            // Fill each bar in turn, as full as it will go; best fit on very large orders
+    BestFit,           // Each cut, longest first, into the fullest bar it fits
+    ColumnGeneration,  // LP master problem with knapsack pricing, rounded to whole bars
+    LocalSearch        // Seeded searches that repack a few bars at a time, for as long as allowed
+};
+
+struct CuttingResult;
+class RemnantStore;
+class SolveCache;
+class SolveStats;
+
+struct SolverOptions {
+    SolverMode mode = SolverMode::Greedy;
+    unsigned threads = 1;  // Profile groups solved at once, 0 for one per core
+    // Lengths are whole multiples of this inside the solver, 0 for the coarsest
+    // step the job's lengths lie on, see LengthGrid. Lengths off it are rounded
+    // safely, see LengthUnit; the result still gives the job's own lengths.
+    double lengthUnit = 0.0;
+
+    // Local search. The plan depends only on the seed and the number of searches,
+    // so the same seed and thread count give the same plan again, unless the
+    // time limit or a cancel ends the search first.
+    std::uint64_t seed = 1;
+    unsigned searchStarts = 0;   // Searches per profile group, 0 for one per thread
+    int searchMoves = 20000;     // Moves each search makes
+
+    // Offcuts left by earlier jobs, cut before any new stock when given. The
+    // store must stay open until the solve returns.
+    const RemnantStore *remnants = nullptr;
+
+    // Plans of an earlier solve of much the same job, updated by this one. A
+    // profile whose stock, cuts and offcuts are unchanged keeps its plan and is
+    // not solved again; a changed one starts from the bars of its old plan that
+    // still fit. Used by one solve at a time.
+    SolveCache *cache = nullptr;
+
+    // Phase timings and work counters of the solve, added to what it holds
+    SolveStats *stats = nullptr;
+
+    // Checkpoints of a long solve: what a cache would keep, the unfinished
+    // searches included, written to this file every checkpointInterval seconds
+    // and once more when the solve returns. Loaded into the cache of a later
+    // solve of the same job with the same settings, see SolveCache::load, it
+    // lets that solve carry on where this one stopped, even after a crash. A
+    // checkpoint that cannot be written is skipped.
+    std::string checkpointFile;
+    double checkpointInterval = 60.0;
+
+    // Optional control of a long solve. The callbacks run on the solver's threads,
+    // one call at a time.
+    double timeLimit = 0.0;                        // Wall-clock budget in seconds, 0 for none
+    const std::atomic<bool> *cancelled = nullptr;  // Set from another thread to stop early
+    std::function<void(double)> onProgress;        // Fraction of the work done, 0 to 1
+    std::function<void(const CuttingResult &)> onIncumbent;  // Each better complete plan found
+};
+
+const char *solverModeName(SolverMode mode);
+bool parseSolverMode(const std::string &name, SolverMode &mode);
+
+struct CuttingResult {
+    std::vector<CuttingScheme> schemes;
+    std::vector<Shortage> shortages;
+    double totalStockLength = 0.0;  // Total length of available stock
+    double usedStockLength = 0.0;   // Total length actually used in cutting
+    double stockLowerBound = 0.0;   // No plan that cuts every piece that fits a bar cuts less stock
+    // Price of the new bars cut, over the profiles whose stock rows have
+    // prices, and the least any plan cutting every piece that fits would pay
+    // for them; both 0 when no stock is priced. The bound respects how many
+    // bars of each length there are, but unless column generation ran it does
+    // not know which pieces fit which lengths.
+    double stockCost = 0.0;
+    double stockCostLowerBound = 0.0;
+    bool stoppedEarly = false;      // Cancelled or out of time; the plan is the best found so far
+
+    double optimizationPercent() const;
+    double cutStockLength() const;  // Total length of the new bars the plan cuts, offcuts aside
+    // How much more stock the plan cuts than the lower bound, in percent. Only
+    // meaningful without shortages; 0 means the plan is proven optimal.
+    double gapPercent() const;
+};
+
+const char *const checkpointExtension = ".cutckp";
+
+// What a solve keeps for the next one, see SolverOptions::cache. Changing the
+// mode, length unit or search settings starts it over.
+class SolveCache {
+public:
+    SolveCache();
+    ~SolveCache();
+    SolveCache(const SolveCache &) = delete;
+    SolveCache &operator=(const SolveCache &) = delete;
+
+    void clear();
+
+    // The cache as a checkpoint file, the format SolverOptions::checkpointFile
+    // is written in. Loading replaces what the cache holds; on failure it is
+    // left as it was.
+    bool save(const std::string &fileName, std::string *errorMessage = nullptr) const;
+    bool load(const std::string &fileName, std::string *errorMessage = nullptr);
+
+    struct State;  // Inside the solver only
+
+private:
+    friend CuttingResult solveCuttingJob(const CuttingJob &job, const SolverOptions &options);
+
+    std::unique_ptr<State> state;
+};
+
+// Solve a cutting order. Pure computation, safe to call from several threads at once.
+// The result depends on the job, the options and, with a cache, the solves
+// before it. options.threads only counts through searchStarts: left at 0, local
+// search starts one search per thread, so set it to get the same plan on any
+// number of threads.
+// Where a profile has bars of several lengths the plan pays as little as it can
+// for them: by their price where the stock rows give one, otherwise by length.
+// A cancelled or timed out solve still returns a complete plan: every profile is
+// cut at least as well as the greedy fill would.
+CuttingResult solveCuttingJob(const CuttingJob &job, const SolverOptions &options = SolverOptions());
+
+// Human readable report, as shown in the result area of the GUI: the
+// shortages, the schemes, then the summary. Larger plans are better written
+// through a ReportSink (result_writer.h) than made into one string.
+std::string formatLength(double length);
+std::string formatShortage(const Shortage &shortage);
+std::string formatScheme(const CuttingScheme &scheme);
+std::string formatResultSummary(const CuttingResult &result);
+std::string formatCuttingResult(const CuttingResult &result);
+
+// The format follows the extension, see resultFormatOf: the text report, CSV,
+// JSON, a saw cutting list or the binary format for .cutres. Only binary
+// results can be loaded back.
+bool saveResultFile(const std::string &fileName, const CuttingResult &result, std::string *errorMessage = nullptr);
+bool loadResultFile(const std::string &fileName, CuttingResult &result, std::string *errorMessage = nullptr);
+
+#endif // CUTTING_SOLVER_H
@@ -0,0 +1,9 @@
+# Static library build of the solver, for projects that want to link it
+# instead of compiling solver.pri into their own target.
+
+TEMPLATE = lib
+TARGET = cuttingsolver
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+include(solver.pri)
@@ -0,0 +1,118 @@
+#include "length.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Job lengths are typed with a few decimals, and come out of a multiplication a
+// few ulps off the grid they were typed on
+const double gridTolerance = 1e-6;
+
+} // namespace
+
+LengthUnit::LengthUnit(double size) : unitSize(size > 0 ? size : 0.1), perJobUnit(0.0) {
+    // Dividing by 10 gives 1234.5 where multiplying by 0.1 gives 1234.5000000000002
+    double inverse = 1.0 / unitSize;
+    if (std::abs(inverse - std::round(inverse)) < 1e-9 * inverse)
+        perJobUnit = std::round(inverse);
+}
+
+double LengthUnit::units(double length) const {
+    return perJobUnit > 0 ? length * perJobUnit : length / unitSize;
+}
+
+Length LengthUnit::pieceFromJob(double length) const {
+    return static_cast<Length>(std::ceil(units(length) - gridTolerance));
+}
+
+Length LengthUnit::barFromJob(double length) const {
+    return static_cast<Length>(std::floor(units(length) + gridTolerance));
+}
+
+double LengthUnit::toJob(Length length) const {
+    return perJobUnit > 0 ? length / perJobUnit : length * unitSize;
+}
+
+void LengthGrid::add(double length) {
+    static const double scales[] = {1.0, 10.0, 100.0, 1000.0};
+    for (; decimals < 3; ++decimals) {
+        const double scaled = length * scales[decimals];
+        if (std::abs(scaled - std::round(scaled)) < gridTolerance)
+            return;
+    }
+}
+
+double LengthGrid::unit() const {
+    static const double units[] = {1.0, 0.1, 0.01, 0.001};
+    return units[decimals];
+}
+
+void JobLengths::add(Length length, double jobLength, long long count) {
+    if (count <= 0)
+        return;
+    auto &lengths = given[length];
+    auto it = std::find_if(lengths.begin(), lengths.end(),
+                           [&](const std::pair<double, long long> &entry) { return entry.first <= jobLength; });
+    if (it != lengths.end() && it->first == jobLength)
+        it->second += count;
+    else
+        lengths.insert(it, {jobLength, count});
+}
+
+std::pair<double, long long> JobLengths::next(Length length) const {
+    auto it = given.find(length);
+    if (it == given.end() || it->second.empty())
+        return {unit.toJob(length), std::numeric_limits<long long>::max()};
+    return it->second.front();
+}
+
+void JobLengths::take(Length length, long long count) {
+    auto it = given.find(length);
+    while (count > 0 && it != given.end() && !it->second.empty()) {
+        auto &front = it->second.front();
+        const long long taken = std::min(count, front.second);
+        front.second -= taken;
+        count -= taken;
+        if (front.second == 0)
+            it->second.pop_front();
+    }
+}
+
+void handOutBars(JobLengths &stock, JobLengths &pieces, Length stockLength, const std::vector<Length> &cuts, int count,
+                 const std::function<void(double stockLength, const std::vector<double> &cuts, int count)> &run) {
+    std::map<Length, long long> perBar;
+    for (Length cut : cuts)
+        ++perBar[cut];
+
+    std::vector<double> jobCuts;
+    while (count > 0) {
+        // As many bars as every length has enough of its next job length for.
+        // One that has fewer left than a bar takes gives a run of one bar, cut
+        // from that job length and the one after it.
+        long long bars = std::min<long long>(count, stock.next(stockLength).second);
+        for (const auto &lengthAndCount : perBar)
+            bars = std::min(bars, std::max(1LL, pieces.next(lengthAndCount.first).second / lengthAndCount.second));
+
+        const double jobStockLength = stock.next(stockLength).first;
+        stock.take(stockLength, bars);
+        jobCuts.clear();
+        for (Length cut : cuts) {
+            jobCuts.push_back(pieces.next(cut).first);
+            pieces.take(cut, bars);
+        }
+        run(jobStockLength, jobCuts, static_cast<int>(bars));
+        count -= static_cast<int>(bars);
+    }
+}
+
+void handOutPieces(JobLengths &pieces, Length length, int count, const std::function<void(double length, int count)> &run) {
+    while (count > 0) {
+        const auto next = pieces.next(length);
+        const int taken = static_cast<int>(std::min<long long>(count, next.second));
+        pieces.take(length, taken);
+        run(next.first, taken);
+        count -= taken;
+    }
+}
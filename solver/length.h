@@ -0,0 +1,76 @@
+#ifndef LENGTH_H
+#define LENGTH_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Inside the solver every length is a whole number of a small unit, so fits are
+// exact and lengths can index dynamic programming tables directly.
+using Length = std::int64_t;
+
+// Converts between job lengths, as typed into the tables (normally mm), and
+// solver units. Lengths off the grid are rounded the safe way: pieces up, so a
+// plan never cuts less than a piece needs, and bars and offcuts down, so it
+// never counts on more than a bar holds.
+class LengthUnit {
+public:
+    explicit LengthUnit(double unitSize = 0.1);  // Size of one unit in job lengths
+
+    double size() const { return unitSize; }
+    Length pieceFromJob(double length) const;
+    Length barFromJob(double length) const;
+    double toJob(Length length) const;
+
+private:
+    double units(double length) const;
+
+    double unitSize;
+    double perJobUnit;  // Units per job length, when that is a whole number
+};
+
+// The coarsest of 0.1, 0.01 and 0.001 that every length added lies on: the
+// unit of a solve that leaves it to the job. Lengths finer than 0.001 are
+// rounded on that grid. Whole mm work in 0.1 as they always have; a coarser
+// unit gains nothing, and the solvers' tolerances are tuned for it.
+class LengthGrid {
+public:
+    void add(double length);
+    double unit() const;
+
+private:
+    int decimals = 1;
+};
+
+// The job lengths behind each solver length, so that a plan is reported with
+// the lengths that were asked for and not the ones they were rounded to.
+// Several job lengths can round to one solver length; each is handed out as
+// many times as it was given, longest first.
+class JobLengths {
+public:
+    explicit JobLengths(const LengthUnit &unit) : unit(unit) {}
+
+    void add(Length length, double jobLength, long long count);
+
+    // The next job length behind `length` and how many of it are left. A length
+    // never given, or given out in full, is its solver length, without limit.
+    std::pair<double, long long> next(Length length) const;
+    void take(Length length, long long count);
+
+private:
+    LengthUnit unit;
+    std::map<Length, std::deque<std::pair<double, long long>>> given;
+};
+
+// Bars cut alike in solver lengths need not be alike once job lengths are
+// handed out to them. Calls `run` for every run of the `count` bars of this
+// stock length and cuts that are cut alike in job lengths, longest first.
+void handOutBars(JobLengths &stock, JobLengths &pieces, Length stockLength, const std::vector<Length> &cuts, int count,
+                 const std::function<void(double stockLength, const std::vector<double> &cuts, int count)> &run);
+// The same for `count` pieces of one length that are not cut
+void handOutPieces(JobLengths &pieces, Length length, int count, const std::function<void(double length, int count)> &run);
+
+#endif // LENGTH_H
@@ -0,0 +1,409 @@
+// Large-neighbourhood search for one profile group. A move takes a few bars
+// apart, the emptiest among them, and repacks their pieces best fit decreasing
+// into the other bars and, if need be, new ones. The move is kept when
+// the plan covers no fewer pieces and pays no more for stock; among equal plans the
+// one with the free length gathered into fewer bars wins, which is what lets a
+// later move empty a bar completely.
+
+#include "local_search.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <utility>
+
+namespace {
+
+// splitmix64; the standard engines and distributions are not guaranteed to
+// give the same numbers everywhere, and plans have to be reproducible
+std::uint64_t nextRandom(std::uint64_t &state) {
+    std::uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+std::size_t randomBelow(std::uint64_t &state, std::size_t bound) {
+    return static_cast<std::size_t>(nextRandom(state) % bound);
+}
+
+double roomSquared(Length room) {
+    return static_cast<double>(room) * static_cast<double>(room);
+}
+
+const int maxDestroyedBars = 4;
+const std::size_t maxRepackedShortages = 64;  // Missing pieces offered to one move
+const int maxSwaps = 16;              // Pieces pushed out of bars in one move
+const int swapCandidates = 8;         // Bars looked at for each push
+
+} // namespace
+
+GroupSearch::GroupSearch(const ProfileGroup &group, std::uint64_t seed, std::uint64_t stream)
+    : pieceLengths(group.pieceLengths), random(seed) {
+    random ^= nextRandom(stream);
+    for (const auto &stockClass : group.stock) {
+        stockLengths.push_back(stockClass.length);
+        stockCosts.push_back(stockClass.cost);
+        available.push_back(stockClass.available);
+    }
+    unplaced.assign(pieceLengths.size(), 0);
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        if (lengthAndQuantity.second > 0) {
+            unplaced[pieceIndex(group, lengthAndQuantity.first)] += lengthAndQuantity.second;
+            missing += lengthAndQuantity.second;
+        }
+    }
+}
+
+// Open the longest bar left that takes the length
+bool GroupSearch::openBar(Length length) {
+    for (std::size_t k = 0; k < stockLengths.size(); ++k) {
+        if (available[k] > 0 && stockLengths[k] >= length) {
+            --available[k];
+            bars.push_back({static_cast<std::uint32_t>(k), stockLengths[k], {}});
+            if (!spareItems.empty()) {
+                bars.back().items.swap(spareItems.back());
+                spareItems.pop_back();
+            }
+            ++openedBars;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GroupSearch::closeBars(std::size_t count) {
+    while (bars.size() > count) {
+        spareItems.push_back(std::move(bars.back().items));
+        spareItems.back().clear();
+        bars.pop_back();
+    }
+}
+
+void GroupSearch::index(std::size_t b) {
+    if (spareNodes.empty()) {
+        byRoom.emplace(bars[b].room, b);
+        return;
+    }
+    RoomIndex::node_type node = std::move(spareNodes.back());
+    spareNodes.pop_back();
+    node.value() = {bars[b].room, b};
+    byRoom.insert(std::move(node));
+}
+
+// Move the bar's cuts to the cheapest bar left that holds them, the shortest on a tie
+void GroupSearch::shrinkBar(std::size_t b) {
+    Bar &bar = bars[b];
+    const Length used = stockLengths[bar.stockClass] - bar.room;
+    std::size_t cheapest = bar.stockClass;
+    for (std::size_t k = stockLengths.size(); k-- > 0;) {
+        if (available[k] > 0 && stockLengths[k] >= used && stockCosts[k] < stockCosts[cheapest])
+            cheapest = k;
+    }
+    if (cheapest == bar.stockClass)
+        return;
+    unindex(b);
+    ++available[bar.stockClass];
+    --available[cheapest];
+    bar.stockClass = static_cast<std::uint32_t>(cheapest);
+    bar.room = stockLengths[cheapest] - used;
+    index(b);
+}
+
+void GroupSearch::startFrom(const std::vector<GroupScheme> &schemes) {
+    for (const auto &scheme : schemes) {
+        const auto k = static_cast<std::uint32_t>(
+            std::find(stockLengths.begin(), stockLengths.end(), scheme.stockLength) - stockLengths.begin());
+        Bar bar{k, scheme.remainder, std::vector<CutPattern::Index>(scheme.cuts.begin(), scheme.cuts.end())};
+        for (CutPattern::Index item : bar.items)
+            unplaced[item] -= scheme.count;
+        missing -= static_cast<int>(bar.items.size()) * scheme.count;
+        for (int c = 0; c < scheme.count; ++c) {
+            byRoom.emplace(bar.room, bars.size());
+            bars.push_back(bar);
+        }
+        available[k] -= scheme.count;
+        stock += stockCosts[k] * scheme.count;
+    }
+}
+
+void GroupSearch::construct() {
+    // Longest first, with every length stretched by up to an eighth at random
+    // so that each search packs the pieces in a different order
+    std::vector<std::pair<Length, CutPattern::Index>> pieces;
+    for (std::size_t i = 0; i < pieceLengths.size(); ++i) {
+        for (int c = 0; c < unplaced[i]; ++c) {
+            Length jitter = static_cast<Length>(randomBelow(random, 1024));
+            pieces.emplace_back(pieceLengths[i] * (8192 + jitter), static_cast<CutPattern::Index>(i));
+        }
+    }
+    std::stable_sort(pieces.begin(), pieces.end(), std::greater<>());
+
+    for (const auto &piece : pieces) {
+        const CutPattern::Index item = piece.second;
+        if (!fitPiece(item, bars.size(), nullptr)) {
+            if (!openBar(pieceLengths[item]))
+                continue;
+            index(bars.size() - 1);
+            fitPiece(item, bars.size(), nullptr);
+        }
+        --unplaced[item];
+        --missing;
+    }
+
+    stock = 0;
+    for (std::size_t b = 0; b < bars.size(); ++b) {
+        shrinkBar(b);
+        stock += stockCosts[bars[b].stockClass];
+    }
+}
+
+void GroupSearch::copyPlan(const GroupSearch &other) {
+    bars = other.bars;
+    byRoom = other.byRoom;
+    available = other.available;
+    unplaced = other.unplaced;
+    missing = other.missing;
+    stock = other.stock;
+}
+
+void GroupSearch::saveBars(std::vector<GroupScheme> &schemes) const {
+    schemes.clear();
+    schemes.reserve(bars.size());
+    for (const auto &bar : bars) {
+        GroupScheme scheme{stockLengths[bar.stockClass], CutPattern(), bar.room, 1};
+        for (CutPattern::Index item : bar.items)
+            scheme.cuts.push_back(item);
+        schemes.push_back(std::move(scheme));
+    }
+}
+
+void GroupSearch::resume(const std::vector<GroupScheme> &schemes, std::uint64_t randomState) {
+    startFrom(schemes);
+    random = randomState;
+}
+
+void GroupSearch::touch(std::size_t b, std::size_t oldBars, std::vector<Touched> *touched) {
+    if (touched && b < oldBars
+        && std::find_if(touched->begin(), touched->end(), [b](const Touched &t) { return t.bar == b; }) == touched->end()) {
+        touched->push_back({b, undoItems.size(), bars[b].items.size(), bars[b].room});
+        undoItems.insert(undoItems.end(), bars[b].items.begin(), bars[b].items.end());
+    }
+}
+
+bool GroupSearch::fitPiece(CutPattern::Index item, std::size_t oldBars, std::vector<Touched> *touched) {
+    const Length length = pieceLengths[item];
+
+    // The tightest bar it fits, or now and then the next tightest
+    auto it = byRoom.lower_bound({length, 0});
+    if (it == byRoom.end())
+        return false;
+    if (randomBelow(random, 4) == 0 && std::next(it) != byRoom.end())
+        ++it;
+
+    const std::size_t b = it->second;
+    touch(b, oldBars, touched);
+    unindex(it);
+    bars[b].items.push_back(item);
+    bars[b].room -= length;
+    index(b);
+    return true;
+}
+
+bool GroupSearch::swapPiece(CutPattern::Index item, std::size_t oldBars, const std::vector<std::size_t> &excluded,
+                            std::vector<Touched> &touched, CutPattern::Index &displaced) {
+    const Length length = pieceLengths[item];
+    std::size_t bestBar = 0;
+    std::size_t bestSlot = 0;
+    Length bestRoom = -1;
+    for (int attempt = 0; attempt < swapCandidates && oldBars > 0; ++attempt) {
+        const std::size_t b = randomBelow(random, oldBars);
+        if (std::find(excluded.begin(), excluded.end(), b) != excluded.end())
+            continue;
+        const Bar &bar = bars[b];
+        for (std::size_t slot = 0; slot < bar.items.size(); ++slot) {
+            const Length shorter = pieceLengths[bar.items[slot]];
+            const Length room = bar.room + shorter - length;
+            if (shorter < length && room >= 0 && (bestRoom < 0 || room < bestRoom)) {
+                bestBar = b;
+                bestSlot = slot;
+                bestRoom = room;
+            }
+        }
+    }
+    if (bestRoom < 0)
+        return false;
+
+    Bar &bar = bars[bestBar];
+    touch(bestBar, oldBars, &touched);
+    unindex(bestBar);
+    displaced = bar.items[bestSlot];
+    bar.items[bestSlot] = item;
+    bar.room = bestRoom;
+    index(bestBar);
+    return true;
+}
+
+int GroupSearch::improve(int moves, const std::function<bool()> &stop) {
+    std::vector<std::size_t> destroyed;
+    std::vector<Touched> touched;
+    std::vector<CutPattern::Index> pool;
+    std::vector<CutPattern::Index> offered;  // The missing pieces in the pool
+    std::vector<CutPattern::Index> leftOver;
+
+    for (int move = 0; move < moves; ++move) {
+        if (move % 64 == 0 && stop())
+            return move;
+        const std::size_t barCount = bars.size();
+        if (barCount == 0 && missing == 0)
+            return move;
+
+        // The bar with most room of three random ones, and a few more at random
+        destroyed.clear();
+        if (barCount > 0) {
+            std::size_t first = randomBelow(random, barCount);
+            for (int t = 0; t < 2; ++t) {
+                std::size_t other = randomBelow(random, barCount);
+                if (bars[other].room > bars[first].room)
+                    first = other;
+            }
+            destroyed.push_back(first);
+            const std::size_t wanted = std::min<std::size_t>(barCount, 2 + randomBelow(random, maxDestroyedBars - 1));
+            for (int attempt = 0; destroyed.size() < wanted && attempt < 4 * maxDestroyedBars; ++attempt) {
+                std::size_t b = randomBelow(random, barCount);
+                if (std::find(destroyed.begin(), destroyed.end(), b) == destroyed.end())
+                    destroyed.push_back(b);
+            }
+        }
+
+        pool.clear();
+        for (std::size_t b : destroyed)
+            pool.insert(pool.end(), bars[b].items.begin(), bars[b].items.end());
+        offered.clear();
+        for (std::size_t i = 0; i < unplaced.size() && offered.size() < maxRepackedShortages; ++i) {
+            if (pieceLengths[i] > stockLengths.front())
+                continue;  // Fits no bar at all
+            for (int c = 0; c < unplaced[i] && offered.size() < maxRepackedShortages; ++c)
+                offered.push_back(static_cast<CutPattern::Index>(i));
+        }
+        pool.insert(pool.end(), offered.begin(), offered.end());
+        const int shortages = static_cast<int>(offered.size());
+        if (pool.empty())
+            continue;
+        std::sort(pool.begin(), pool.end());  // Longest first
+
+        // Take the bars apart; they stay in place, out of the room index, until
+        // the move is kept
+        Length oldStock = 0;
+        double oldRoom = 0.0;
+        for (std::size_t b : destroyed) {
+            unindex(b);
+            oldStock += stockCosts[bars[b].stockClass];
+            oldRoom += roomSquared(bars[b].room);
+            ++available[bars[b].stockClass];
+        }
+
+        // Best fit decreasing over all the other bars. A piece that fits none
+        // first tries to push a shorter piece out of a bar, which then goes
+        // round again; only then does it get a new bar.
+        touched.clear();
+        undoItems.clear();
+        leftOver.clear();
+        int swaps = 0;
+        for (std::size_t p = 0; p < pool.size(); ++p) {
+            const CutPattern::Index item = pool[p];
+            CutPattern::Index displaced;
+            if (fitPiece(item, barCount, &touched))
+                continue;
+            if (swaps < maxSwaps && swapPiece(item, barCount, destroyed, touched, displaced)) {
+                ++swaps;
+                pool.push_back(displaced);
+                continue;
+            }
+            if (!openBar(pieceLengths[item])) {
+                leftOver.push_back(item);
+                continue;
+            }
+            index(bars.size() - 1);
+            fitPiece(item, barCount, &touched);
+        }
+
+        Length newStock = 0;
+        double newRoom = 0.0;
+        for (const Touched &t : touched) {
+            oldRoom += roomSquared(t.room);
+            newRoom += roomSquared(bars[t.bar].room);
+        }
+        for (std::size_t b = barCount; b < bars.size(); ++b) {
+            shrinkBar(b);
+            newStock += stockCosts[bars[b].stockClass];
+            newRoom += roomSquared(bars[b].room);
+        }
+
+        const int newShortages = static_cast<int>(leftOver.size());
+        const bool keep = newShortages < shortages
+                          || (newShortages == shortages
+                              && (newStock < oldStock || (newStock == oldStock && newRoom >= oldRoom)));
+        if (!keep) {
+            for (const Touched &t : touched) {
+                Bar &bar = bars[t.bar];
+                unindex(t.bar);
+                bar.items.assign(undoItems.begin() + t.firstItem, undoItems.begin() + t.firstItem + t.itemCount);
+                bar.room = t.room;
+                index(t.bar);
+            }
+            for (std::size_t b = barCount; b < bars.size(); ++b) {
+                unindex(b);
+                ++available[bars[b].stockClass];
+            }
+            closeBars(barCount);
+            for (std::size_t b : destroyed) {
+                index(b);
+                --available[bars[b].stockClass];
+            }
+            continue;
+        }
+
+        // Remove the emptied bars from the back, so that the last bar moved into
+        // a hole is never one still to be removed
+        std::sort(destroyed.begin(), destroyed.end(), std::greater<>());
+        for (std::size_t b : destroyed) {
+            const std::size_t last = bars.size() - 1;
+            if (b != last) {
+                unindex(last);
+                std::swap(bars[b], bars[last]);
+                index(b);
+            }
+            closeBars(last);
+        }
+
+        for (CutPattern::Index item : offered)
+            --unplaced[item];
+        for (CutPattern::Index item : leftOver)
+            ++unplaced[item];
+        missing += newShortages - shortages;
+        stock += newStock - oldStock;
+    }
+    return moves;
+}
+
+void GroupSearch::takePlan(ProfileGroup &group, std::vector<GroupScheme> &schemes) const {
+    for (const auto &bar : bars) {
+        GroupScheme scheme{stockLengths[bar.stockClass], CutPattern(), bar.room, 1};
+        for (CutPattern::Index item : bar.items)
+            scheme.cuts.push_back(item);
+        scheme.cuts.canonicalize();
+        schemes.push_back(std::move(scheme));
+    }
+
+    // What is left uncut, spread back over the group's rows
+    std::vector<int> left = unplaced;
+    for (auto &lengthAndQuantity : group.lengthsToCut) {
+        int &remaining = left[pieceIndex(group, lengthAndQuantity.first)];
+        int uncut = std::min(lengthAndQuantity.second, remaining);
+        remaining -= uncut;
+        lengthAndQuantity.second = uncut;
+    }
+    for (std::size_t k = 0; k < group.stock.size(); ++k)
+        group.stock[k].available = available[k];
+}
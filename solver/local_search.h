@@ -0,0 +1,102 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+// Internal to the solver: one seeded large-neighbourhood search on a profile
+// group. Several of them run side by side on every group; a search depends only
+// on its seed and the moves it is given, never on timing or on the others.
+
+#include "profile_group.h"
+
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+class GroupSearch {
+public:
+    // `stream` tells apart the searches that share a seed
+    GroupSearch(const ProfileGroup &group, std::uint64_t seed, std::uint64_t stream);
+
+    // The first plan: an existing one, such as the greedy fill, or a randomized
+    // best fit decreasing of the search's own
+    void startFrom(const std::vector<GroupScheme> &schemes);
+    void construct();
+
+    // Take over another search's plan, keeping this search's random stream
+    void copyPlan(const GroupSearch &other);
+
+    // The search as it stands, for a checkpoint: its bars in order, as schemes
+    // of one bar each with the cuts as held, and its random state. resume puts
+    // a new search of the same group back exactly where this one was.
+    void saveBars(std::vector<GroupScheme> &schemes) const;
+    std::uint64_t randomState() const { return random; }
+    void resume(const std::vector<GroupScheme> &bars, std::uint64_t randomState);
+
+    // Destroy a few bars and repack their pieces, `moves` times, keeping every
+    // repair that is no worse. `stop` is polled every few moves. Returns the
+    // moves made.
+    int improve(int moves, const std::function<bool()> &stop);
+
+    int missingPieces() const { return missing; }
+    Length stockUsed() const { return stock; }  // Cost of the bars, see StockClass::cost
+    std::uint64_t barsOpened() const { return openedBars; }  // Since the search was made
+
+    // The current plan as schemes of one bar each. Consumes the quantities in
+    // group.lengthsToCut and the bars in group.stock, like the other solvers.
+    void takePlan(ProfileGroup &group, std::vector<GroupScheme> &schemes) const;
+
+private:
+    struct Bar {
+        std::uint32_t stockClass;
+        Length room;                        // Length left over
+        std::vector<CutPattern::Index> items;
+    };
+
+    // A bar a move changed, as it was before; its items are in undoItems
+    struct Touched {
+        std::size_t bar;
+        std::size_t firstItem;
+        std::size_t itemCount;
+        Length room;
+    };
+
+    using RoomIndex = std::set<std::pair<Length, std::size_t>>;
+
+    bool openBar(Length length);
+    void shrinkBar(std::size_t bar);
+    // Drop the bars from `count` on
+    void closeBars(std::size_t count);
+
+    // Take a bar out of the room index and put it back under its current room.
+    // Every move re-keys dozens of bars; the nodes and the item lists of closed
+    // bars are kept for reuse instead of going back to the heap each time.
+    void unindex(std::size_t bar) { unindex(byRoom.find({bars[bar].room, bar})); }
+    void unindex(RoomIndex::iterator it) { spareNodes.push_back(byRoom.extract(it)); }
+    void index(std::size_t bar);
+
+    // Bars before `oldBars` that change are recorded in `touched`, when given
+    void touch(std::size_t bar, std::size_t oldBars, std::vector<Touched> *touched);
+    bool fitPiece(CutPattern::Index item, std::size_t oldBars, std::vector<Touched> *touched);
+    // Put the piece in place of a shorter one in a random bar, outside `excluded`
+    bool swapPiece(CutPattern::Index item, std::size_t oldBars, const std::vector<std::size_t> &excluded,
+                   std::vector<Touched> &touched, CutPattern::Index &displaced);
+
+    std::vector<Length> pieceLengths;       // As in the group, indexed by CutPattern::Index
+    std::vector<Length> stockLengths;       // Longest first
+    std::vector<Length> stockCosts;
+    std::uint64_t random;
+
+    std::vector<Bar> bars;
+    RoomIndex byRoom;                       // Room and index of every bar in the plan
+    std::vector<CutPattern::Index> undoItems;  // Items of the bars the current move touched
+    std::vector<RoomIndex::node_type> spareNodes;
+    std::vector<std::vector<CutPattern::Index>> spareItems;
+    std::vector<int> available;             // Bars left per stock class
+    std::vector<int> unplaced;              // Pieces not in any bar, per length
+    int missing = 0;
+    Length stock = 0;
+    std::uint64_t openedBars = 0;
+};
+
+#endif // LOCAL_SEARCH_H
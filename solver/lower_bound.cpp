@@ -0,0 +1,123 @@
+// Lower bounds on the stock a profile group needs, cheap enough to compute for
+// every group of every solve. A plan that cuts exactly this much is optimal and
+// no solver has to look any further.
+
+#include "profile_group.h"
+
+#include <algorithm>
+
+namespace {
+
+Length ceilDivide(Length numerator, Length denominator) {
+    return numerator <= 0 ? 0 : (numerator + denominator - 1) / denominator;
+}
+
+// Martello and Toth's L2 bound on the number of bars of length `capacity` for the
+// given pieces, longest first, with the continuous bound L1 as the case alpha = 0.
+// For every alpha up to half a bar, pieces longer than capacity - alpha each need a
+// bar of their own, as do the pieces over half a bar; the pieces from alpha to half
+// a bar fill what those leave free and then whole bars.
+Length barLowerBound(const std::vector<std::pair<Length, int>> &pieces, Length capacity) {
+    // Prefix counts and lengths, so each alpha costs two binary searches
+    const size_t n = pieces.size();
+    std::vector<Length> countBefore(n + 1, 0);
+    std::vector<Length> lengthBefore(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        countBefore[i + 1] = countBefore[i] + pieces[i].second;
+        lengthBefore[i + 1] = lengthBefore[i] + pieces[i].first * pieces[i].second;
+    }
+    auto longerThan = [&](Length length) {  // Number of entries longer than `length`
+        return static_cast<size_t>(std::partition_point(pieces.begin(), pieces.end(), [&](const std::pair<Length, int> &piece) {
+                   return piece.first > length;
+               }) - pieces.begin());
+    };
+
+    const size_t overHalf = longerThan(capacity / 2);
+    Length bound = ceilDivide(lengthBefore[n], capacity);
+    for (size_t a = n; a-- > overHalf;) {
+        const Length alpha = pieces[a].first;
+        if (a + 1 < n && pieces[a + 1].first == alpha)
+            continue;
+        const size_t large = longerThan(capacity - alpha);
+        const Length ownBars = countBefore[overHalf];
+        const Length freeInOwnBars = (countBefore[overHalf] - countBefore[large]) * capacity
+                                     - (lengthBefore[overHalf] - lengthBefore[large]);
+        const Length smallLength = lengthBefore[a + 1] - lengthBefore[overHalf];
+        bound = std::max(bound, ownBars + ceilDivide(smallLength - freeInOwnBars, capacity));
+    }
+    return std::max(bound, countBefore[overHalf]);
+}
+
+// ceil(amount * cost / length), without overflowing on the product
+Length scale(Length amount, Length cost, Length length) {
+    return amount / length * cost + ceilDivide(amount % length * cost, length);
+}
+
+Length lowerBound(const ProfileGroup &group, bool byCost) {
+    if (group.stock.empty())
+        return 0;
+    const Length longestStock = group.stock.front().length;
+
+    // Pieces that fit no bar are shortages whatever the plan, so they do not count
+    std::vector<std::pair<Length, int>> pieces;
+    Length pieceLength = 0;
+    for (const auto &lengthAndQuantity : group.lengthsToCut) {
+        if (lengthAndQuantity.first <= 0 || lengthAndQuantity.first > longestStock || lengthAndQuantity.second <= 0)
+            continue;
+        if (!pieces.empty() && pieces.back().first == lengthAndQuantity.first)
+            pieces.back().second += lengthAndQuantity.second;
+        else
+            pieces.push_back(lengthAndQuantity);
+        pieceLength += lengthAndQuantity.first * lengthAndQuantity.second;
+    }
+    if (pieces.empty())
+        return 0;
+
+    // Bars are spent cheapest first, but no class gives more than it has. With
+    // several stock lengths the bars are counted as if all were the longest.
+    auto costOf = [&](const StockClass &stock) { return byCost ? stock.cost : stock.length; };
+    std::vector<const StockClass *> classes;
+    for (const auto &stock : group.stock) {
+        if (stock.length > 0 && stock.available > 0)
+            classes.push_back(&stock);
+    }
+
+    // Every piece at the lowest cost per length still available
+    std::sort(classes.begin(), classes.end(), [&](const StockClass *a, const StockClass *b) {
+        return costOf(*a) * b->length < costOf(*b) * a->length;
+    });
+    Length pieceCost = 0;
+    Length uncovered = pieceLength;
+    for (const StockClass *stock : classes) {
+        const Length covered = std::min(uncovered, stock->length * stock->available);
+        pieceCost += scale(covered, costOf(*stock), stock->length);
+        uncovered -= covered;
+        if (uncovered == 0)
+            break;
+    }
+
+    // The L2 number of bars, each from the cheapest bars still available
+    std::sort(classes.begin(), classes.end(), [&](const StockClass *a, const StockClass *b) {
+        return costOf(*a) < costOf(*b);
+    });
+    Length barsCost = 0;
+    Length barsLeft = barLowerBound(pieces, longestStock);
+    for (const StockClass *stock : classes) {
+        const Length bars = std::min<Length>(barsLeft, stock->available);
+        barsCost += bars * costOf(*stock);
+        barsLeft -= bars;
+        if (barsLeft == 0)
+            break;
+    }
+    return std::max(pieceCost, barsCost);
+}
+
+} // namespace
+
+Length stockLowerBound(const ProfileGroup &group) {
+    return lowerBound(group, true);
+}
+
+Length stockLengthLowerBound(const ProfileGroup &group) {
+    return lowerBound(group, false);
+}
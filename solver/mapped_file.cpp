@@ -0,0 +1,114 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &fileName, std::string *errorMessage) {
+    close();
+    file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        if (errorMessage)
+            *errorMessage = "Cannot open file: " + fileName + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        if (errorMessage)
+            *errorMessage = "Cannot read file: " + fileName + " (error " + std::to_string(GetLastError()) + ")";
+        close();
+        return false;
+    }
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    if (length == 0)
+        return true;  // Empty files cannot be mapped, and need not be
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        bytes = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        if (errorMessage)
+            *errorMessage = "Cannot map file: " + fileName + " (error " + std::to_string(GetLastError()) + ")";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+    bytes = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    length = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string &fileName, std::string *errorMessage) {
+    close();
+    descriptor = ::open(fileName.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        if (errorMessage)
+            *errorMessage = "Cannot open file: " + fileName + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        if (errorMessage)
+            *errorMessage = "Cannot read file: " + fileName + " (" + std::strerror(errno) + ")";
+        close();
+        return false;
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    if (length == 0)
+        return true;  // Empty files cannot be mapped, and need not be
+
+    void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (address == MAP_FAILED) {
+        if (errorMessage)
+            *errorMessage = "Cannot map file: " + fileName + " (" + std::strerror(errno) + ")";
+        close();
+        return false;
+    }
+    madvise(address, length, MADV_SEQUENTIAL);
+    bytes = static_cast<const char *>(address);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes)
+        munmap(const_cast<char *>(bytes), length);
+    if (descriptor >= 0)
+        ::close(descriptor);
+    bytes = nullptr;
+    descriptor = -1;
+    length = 0;
+}
+
+#endif
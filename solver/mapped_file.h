@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Internal to the solver: read-only view of a whole file, memory-mapped so that
+// large orders are parsed in place without being copied.
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &fileName, std::string *errorMessage = nullptr);
+    void close();
+
+    const char *data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+private:
+    const char *bytes = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void *file = nullptr;
+    void *mapping = nullptr;
+#else
+    int descriptor = -1;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,125 @@
+#ifndef PROFILE_GROUP_H
+#define PROFILE_GROUP_H
+
+// Internal to the solver: the stock and demand of one profile, which is solved
+// independently of every other profile.
+
+#include "cut_pattern.h"
+#include "cutting_solver.h"
+#include "length.h"
+#include "solve_stats.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// All bars of one profile with the same length
+struct StockClass {
+    Length length;
+    int available;   // Bars not cut yet
+    Length cost;     // Price of one bar, see priceStock; its length when the stock is not priced
+};
+
+// The solvers weigh stock by its cost, which for a profile without prices is
+// its length: plans, lower bounds and incumbents below are all in cost.
+struct ProfileGroup {
+    std::string profileName;
+    std::vector<StockClass> stock;                     // Distinct lengths, longest first
+    std::vector<std::pair<Length, int>> lengthsToCut;  // Length and quantity still to cut, longest first
+    std::vector<Length> pieceLengths;                  // Distinct lengths to cut, longest first; patterns index this
+    Length stockLowerBound = 0;                        // No plan that cuts every piece costs less
+    double costRate = 0.0;                             // Price of one unit of cost, 0 when the stock has no prices
+    Length lengthLowerBound = 0;                       // ... nor cuts less stock; only set when priced
+};
+
+// Position of a length in group.pieceLengths, which must contain it
+CutPattern::Index pieceIndex(const ProfileGroup &group, Length length);
+
+// Set the cost of every stock class from the price of one of its bars, in the
+// job's currency, with 0 for none. Costs are kept in length units so that the
+// solvers compare them like lengths: the longest priced bar costs its length,
+// the others in proportion to their price, and bars without a price cost
+// their length too. costRate turns costs back into prices.
+void priceStock(ProfileGroup &group, const std::vector<double> &prices);
+
+// Cost of a bar of the given length, which should be one of `stock`
+Length barCost(const std::vector<StockClass> &stock, Length stockLength);
+
+// Least total cost any plan that cuts all of the group's pieces must pay: the
+// larger of the continuous bound, every piece at the lowest cost per length,
+// and Martello and Toth's L2 on the number of bars at the cheapest bars. Each
+// length gives no more bars than it has, but any piece may go on any of them.
+// Pieces longer than every bar are left out, since no plan can cut them.
+Length stockLowerBound(const ProfileGroup &group);
+// The same in stock length, whatever the bars cost
+Length stockLengthLowerBound(const ProfileGroup &group);
+
+// Cancellation flag and deadline of one solve, polled by the long running loops
+class StopCondition {
+public:
+    explicit StopCondition(const SolverOptions &options);
+    bool shouldStop() const;
+
+private:
+    const std::atomic<bool> *cancelled;
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+// Fill every bar in turn: the longest piece left, then the rest of the bar with
+// the longest cuts that still fit, and again with the fullest fill of the rest
+// (BarFiller), taking the longest bars first; with several stock lengths also
+// with the fullest fill, bar by bar, of whichever length cuts most for its
+// cost. The plan cutting more, or the same for less, is kept.
+// Consumes the quantities in group.lengthsToCut and the bars in group.stock,
+// and appends one scheme per distinct way a bar was cut, with the number of
+// bars cut like it.
+void solveGroupGreedy(ProfileGroup &group, std::vector<GroupScheme> &schemes);
+
+// Cut what can be cut from the yard's offcuts before any new bar is touched:
+// the longest piece left goes into the shortest offcut that takes it, which is
+// then filled with the longest pieces that still fit. `remnants` are the
+// profile's offcut lengths, shortest first. Consumes quantities like
+// solveGroupGreedy, and appends the offcuts cut as schemes.
+void solveGroupRemnants(ProfileGroup &group, const std::vector<Length> &remnants, std::vector<GroupScheme> &schemes);
+
+// Best fit decreasing: each piece, longest first, into the open bar with least
+// room that takes it, opening the longest bar left when none does; bars are
+// moved to the cheapest stock length that holds their cuts at the end. Where a
+// shorter length costs less per length, a second pass opens the bar that costs
+// least for what it can be filled with, and is kept when it wins. Takes
+// O(pieces log bars), where solveGroupGreedy scans every length for every bar.
+// Consumes quantities and bars like solveGroupGreedy.
+void solveGroupBestFit(ProfileGroup &group, std::vector<GroupScheme> &schemes);
+
+// The LP keeps a dense basis with a row per distinct length and per stock
+// length, squared, so groups with more lengths than this are not solved by
+// column generation
+const std::size_t maxColumnGenerationLengths = 2000;
+
+// Gilmore-Gomory column generation followed by rounding; whatever the rounded
+// plan does not cover is finished with solveGroupGreedy on the unused bars.
+// When `stop` fires the LP work is abandoned and the greedy pass finishes the
+// group, so the schemes always form a complete plan.
+// Patterns cost what their bar does. The LP relaxation raises
+// group.stockLowerBound. If that proves a plan already found optimal, one that
+// cuts every piece for `incumbentStock`, the group is left alone and false is
+// returned. Pass 0 when there is no such plan.
+// Patterns priced and LP iterations are counted in `stats`, when given.
+// `patterns`, when given, seeds the first LP with the pool an earlier solve of
+// the same group left, and is set to the pool this one leaves: the patterns
+// the LP uses, or every pattern priced so far when `stop` cut it short.
+bool solveGroupColumnGeneration(ProfileGroup &group, std::vector<GroupScheme> &schemes, const StopCondition &stop,
+                                Length incumbentStock = 0, SolveStats *stats = nullptr,
+                                std::vector<GroupScheme> *patterns = nullptr);
+
+// The same rounding over a fixed set of patterns, such as the bars of plans cut
+// for parts of the demand: the LP uses them, the homogeneous patterns and the
+// greedy ones, but prices no new ones and proves no bound. Its size stays
+// within the patterns given and the distinct lengths.
+void solveGroupOverPatterns(ProfileGroup &group, std::vector<GroupScheme> patterns, std::vector<GroupScheme> &schemes,
+                            const StopCondition &stop, SolveStats *stats = nullptr);
+
+#endif // PROFILE_GROUP_H
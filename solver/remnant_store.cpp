@@ -0,0 +1,251 @@
+#include "remnant_store.h"
+#include "binary_format.h"
+#include "mapped_file.h"
+#include "profile_group.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <numeric>
+
+namespace {
+
+const char remnantMagic[6] = {'C', 'U', 'T', 'R', 'E', 'M'};
+const std::uint16_t remnantVersion = 1;
+
+std::string serializeRemnants(const std::map<std::string, std::vector<double>> &remnants) {
+    Writer writer;
+    writer.putBytes(remnantMagic, sizeof(remnantMagic));
+    writer.put(remnantVersion);
+    std::size_t count = 0;
+    for (const auto &entry : remnants)
+        count += entry.second.size();
+    writer.put(static_cast<std::uint32_t>(remnants.size()));
+    writer.put(static_cast<std::uint32_t>(count));
+
+    std::uint32_t first = 0;
+    for (const auto &entry : remnants) {
+        writer.put(static_cast<std::uint32_t>(entry.first.size()));
+        writer.putBytes(entry.first.data(), entry.first.size());
+        writer.put(first);
+        writer.put(static_cast<std::uint32_t>(entry.second.size()));
+        first += static_cast<std::uint32_t>(entry.second.size());
+    }
+    writer.align(8);
+    for (const auto &entry : remnants) {
+        for (double length : entry.second)
+            writer.put(length);
+    }
+    return writer.contents();
+}
+
+} // namespace
+
+RemnantStore::RemnantStore() = default;
+
+RemnantStore::~RemnantStore() = default;
+
+bool RemnantStore::open(const std::string &fileName, std::string *errorMessage) {
+    close();
+    if (std::FILE *probe = std::fopen(fileName.c_str(), "rb")) {
+        std::fclose(probe);
+    } else if (errno == ENOENT) {
+        return true;
+    }
+
+    file = std::make_unique<MappedFile>();
+    if (!file->open(fileName, errorMessage)) {
+        close();
+        return false;
+    }
+
+    auto corrupt = [&]() {
+        if (errorMessage)
+            *errorMessage = fileName + ": not a valid offcut file, or truncated";
+        close();
+        return false;
+    };
+
+    Reader reader(file->data(), file->size());
+    std::uint16_t version;
+    std::uint32_t profileCount, lengthCount;
+    if (!reader.getMagic(remnantMagic) || !reader.get(version))
+        return corrupt();
+    if (version != remnantVersion) {
+        if (errorMessage)
+            *errorMessage = fileName + ": unsupported offcut file version " + std::to_string(version);
+        close();
+        return false;
+    }
+    if (!reader.getCount(profileCount, 3 * sizeof(std::uint32_t)) || !reader.get(lengthCount))
+        return corrupt();
+
+    profiles.resize(profileCount);
+    for (Profile &profile : profiles) {
+        std::uint32_t first, offcuts;
+        if (!reader.getString(profile.name) || !reader.get(first) || !reader.get(offcuts) || first > lengthCount
+            || offcuts > lengthCount - first)
+            return corrupt();
+        profile.first = first;
+        profile.count = offcuts;
+    }
+    if (!std::is_sorted(profiles.begin(), profiles.end(), [](const Profile &a, const Profile &b) { return a.name < b.name; }))
+        return corrupt();
+
+    // The lengths start on the next multiple of 8 bytes, and mappings start on a
+    // page, so they are read in place
+    const std::size_t offset = (static_cast<std::size_t>(reader.current() - file->data()) + 7) / 8 * 8;
+    if (file->size() < offset || (file->size() - offset) / sizeof(double) != lengthCount
+        || (file->size() - offset) % sizeof(double) != 0)
+        return corrupt();
+    lengths = reinterpret_cast<const double *>(file->data() + offset);
+    count = lengthCount;
+    return true;
+}
+
+void RemnantStore::close() {
+    file.reset();
+    profiles.clear();
+    lengths = nullptr;
+    count = 0;
+}
+
+const RemnantStore::Profile *RemnantStore::find(const std::string &profileName) const {
+    auto it = std::lower_bound(profiles.begin(), profiles.end(), profileName,
+                               [](const Profile &profile, const std::string &name) { return profile.name < name; });
+    return it != profiles.end() && it->name == profileName ? &*it : nullptr;
+}
+
+const double *RemnantStore::begin(const std::string &profileName) const {
+    const Profile *profile = find(profileName);
+    return profile ? lengths + profile->first : lengths;
+}
+
+const double *RemnantStore::end(const std::string &profileName) const {
+    const Profile *profile = find(profileName);
+    return profile ? lengths + profile->first + profile->count : lengths;
+}
+
+double RemnantStore::shortestAtLeast(const std::string &profileName, double length) const {
+    const double *last = end(profileName);
+    const double *it = std::lower_bound(begin(profileName), last, length);
+    return it != last ? *it : 0.0;
+}
+
+void RemnantStore::identifyOffcuts(CuttingResult &result) const {
+    std::map<std::pair<std::string, double>, std::size_t> next;  // Next position of each length not given out
+    for (auto &scheme : result.schemes) {
+        scheme.offcuts.clear();
+        if (!scheme.fromRemnant)
+            continue;
+        const double *first = begin(scheme.profileName);
+        const double *last = end(scheme.profileName);
+        auto inserted = next.emplace(std::make_pair(scheme.profileName, scheme.stockLength),
+                                     std::lower_bound(first, last, scheme.stockLength) - first);
+        std::size_t &position = inserted.first->second;
+        for (int c = 0; c < scheme.count && first + position != last && first[position] == scheme.stockLength; ++c)
+            scheme.offcuts.push_back(position++);
+    }
+}
+
+bool RemnantStore::update(const std::string &fileName, const CuttingResult &result, double minLength,
+                          std::string *errorMessage) {
+    std::map<std::string, std::vector<double>> remnants;
+    {
+        RemnantStore store;
+        if (!store.open(fileName, errorMessage))
+            return false;
+        for (const Profile &profile : store.profiles)
+            remnants[profile.name].assign(store.begin(profile.name), store.end(profile.name));
+    }
+
+    // Every offcut cut must still be where the solve found it, and be cut once
+    std::map<std::string, std::vector<char>> used;
+    for (const auto &scheme : result.schemes) {
+        if (!scheme.fromRemnant)
+            continue;
+        const std::vector<double> &lengths = remnants[scheme.profileName];
+        std::vector<char> &cut = used[scheme.profileName];
+        cut.resize(lengths.size(), 0);
+        bool valid = scheme.offcuts.size() == static_cast<std::size_t>(scheme.count);
+        for (std::size_t position : scheme.offcuts) {
+            valid = valid && position < lengths.size() && lengths[position] == scheme.stockLength && !cut[position];
+            if (valid)
+                cut[position] = 1;
+        }
+        if (!valid) {
+            if (errorMessage)
+                *errorMessage = fileName + ": the plan's offcuts of " + scheme.profileName
+                                + " are not in the store; it changed since the plan was made";
+            return false;
+        }
+    }
+    for (auto &entry : used) {
+        std::vector<double> &lengths = remnants[entry.first];
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            if (!entry.second[i])
+                lengths[kept++] = lengths[i];
+        }
+        lengths.resize(kept);
+    }
+    for (const auto &scheme : result.schemes) {
+        if (scheme.remainder >= minLength && scheme.remainder > 0) {
+            std::vector<double> &lengths = remnants[scheme.profileName];
+            lengths.insert(std::upper_bound(lengths.begin(), lengths.end(), scheme.remainder), scheme.count, scheme.remainder);
+        }
+    }
+    for (auto it = remnants.begin(); it != remnants.end();) {
+        if (it->second.empty())
+            it = remnants.erase(it);
+        else
+            ++it;
+    }
+
+    // Readers never see half a file
+    return replaceFile(fileName, serializeRemnants(remnants), errorMessage);
+}
+
+void solveGroupRemnants(ProfileGroup &group, const std::vector<Length> &remnants, std::vector<GroupScheme> &schemes) {
+    // Next offcut not cut yet at or after each position, with path halving, so
+    // that every lookup skips the used ones in near constant time
+    std::vector<std::size_t> next(remnants.size() + 1);
+    std::iota(next.begin(), next.end(), 0);
+    auto unused = [&](std::size_t i) {
+        while (next[i] != i) {
+            next[i] = next[next[i]];
+            i = next[i];
+        }
+        return i;
+    };
+
+    SchemeCounter counter;
+    for (std::size_t row = 0; row < group.lengthsToCut.size(); ++row) {
+        const Length length = group.lengthsToCut[row].first;
+        if (length <= 0)
+            break;
+
+        while (group.lengthsToCut[row].second > 0) {
+            const std::size_t r = unused(std::lower_bound(remnants.begin(), remnants.end(), length) - remnants.begin());
+            if (r == remnants.size())
+                break;
+            next[r] = r + 1;
+
+            // The shortest offcut that takes the longest piece left, filled with
+            // the longest pieces that still fit
+            GroupScheme scheme{remnants[r], CutPattern(), remnants[r], 1};
+            for (std::size_t k = row; k < group.lengthsToCut.size() && group.lengthsToCut[k].first > 0; ++k) {
+                auto &lengthAndQuantity = group.lengthsToCut[k];
+                while (lengthAndQuantity.second > 0 && scheme.remainder >= lengthAndQuantity.first) {
+                    scheme.cuts.push_back(pieceIndex(group, lengthAndQuantity.first));
+                    scheme.remainder -= lengthAndQuantity.first;
+                    --lengthAndQuantity.second;
+                }
+            }
+            counter.add(scheme);
+        }
+    }
+    schemes.insert(schemes.end(), counter.schemes().begin(), counter.schemes().end());
+}
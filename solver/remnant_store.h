@@ -0,0 +1,73 @@
+#ifndef REMNANT_STORE_H
+#define REMNANT_STORE_H
+
+// The yard's offcuts: remainders of earlier jobs that are long enough to cut
+// again, kept in a file between jobs. The file is memory-mapped and only its
+// profile table is read on open; lookups are binary searches over the mapped
+// lengths, so tens of thousands of offcuts cost nothing until they are used.
+//
+// File, version 1:  "CUTREM" u16 version, u32 profiles, u32 offcuts, per profile
+//                   in name order (u32 byte length, bytes, u32 first offcut,
+//                   u32 offcut count), zero padding to a multiple of 8 bytes,
+//                   f64 offcut lengths, each profile's shortest first
+
+#include "cutting_solver.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+// Remainders shorter than this are scrap unless the caller says otherwise
+const double defaultMinRemnantLength = 500.0;
+const char *const remnantStoreExtension = ".cutrem";
+
+class RemnantStore {
+public:
+    RemnantStore();
+    ~RemnantStore();
+
+    // A file that does not exist yet is an empty store
+    bool open(const std::string &fileName, std::string *errorMessage = nullptr);
+    void close();
+
+    std::size_t size() const { return count; }
+
+    // Offcuts of one profile, shortest first, straight from the file
+    const double *begin(const std::string &profileName) const;
+    const double *end(const std::string &profileName) const;
+
+    // Shortest offcut of the profile that is at least `length` long, or 0 when none is
+    double shortestAtLeast(const std::string &profileName, double length) const;
+
+    // Fill in CuttingScheme::offcuts for the schemes of a result solved with
+    // this store. Schemes report the lengths the store holds, so each takes the
+    // next offcuts of exactly its length.
+    void identifyOffcuts(CuttingResult &result) const;
+
+    // Rewrite the store after a job: every offcut the result cut from is gone,
+    // and every remainder of at least minLength is added. Offcuts are removed
+    // by position, and the result must come from a solve with the store as it
+    // is now. Close any store open on the file first; the new file replaces
+    // the old one in a single rename.
+    static bool update(const std::string &fileName, const CuttingResult &result, double minLength,
+                       std::string *errorMessage = nullptr);
+
+private:
+    struct Profile {
+        std::string name;
+        std::size_t first;
+        std::size_t count;
+    };
+
+    const Profile *find(const std::string &profileName) const;
+
+    std::unique_ptr<MappedFile> file;
+    std::vector<Profile> profiles;   // In name order
+    const double *lengths = nullptr;
+    std::size_t count = 0;
+};
+
+#endif // REMNANT_STORE_H
@@ -0,0 +1,207 @@
+#include "result_writer.h"
+#include "binary_format.h"
+#include "text_escape.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Exports are read by programs, so they get more digits than the report
+std::string number(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+    return buffer;
+}
+
+} // namespace
+
+void writeCuttingResult(const CuttingResult &result, ResultSink &sink) {
+    sink.begin(result);
+    for (const auto &shortage : result.shortages)
+        sink.shortage(shortage);
+    for (const auto &scheme : result.schemes)
+        sink.scheme(scheme);
+    sink.end(result);
+}
+
+void TextResultSink::write(const std::string &text) {
+    buffer += text;
+    if (buffer.size() >= chunkSize)
+        flush();
+}
+
+void TextResultSink::flush() {
+    if (!buffer.empty())
+        output(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void ReportSink::shortage(const Shortage &shortage) {
+    write(formatShortage(shortage) + "\n");
+}
+
+void ReportSink::scheme(const CuttingScheme &scheme) {
+    if (scheme.count > 1)
+        write(std::to_string(scheme.count) + " x (" + formatScheme(scheme) + ")\n");
+    else
+        write(formatScheme(scheme) + "\n");
+}
+
+void ReportSink::end(const CuttingResult &result) {
+    write(formatResultSummary(result));
+    flush();
+}
+
+void CsvSink::begin(const CuttingResult &) {
+    write("profile,count,stock_length,remainder,offcut,cuts\n");
+}
+
+void CsvSink::scheme(const CuttingScheme &scheme) {
+    std::string row = csvField(scheme.profileName) + "," + std::to_string(scheme.count) + "," + number(scheme.stockLength)
+                      + "," + number(scheme.remainder) + "," + (scheme.fromRemnant ? "1" : "0") + ",";
+    for (std::size_t i = 0; i < scheme.cuts.size(); ++i) {
+        if (i > 0)
+            row += ' ';
+        row += number(scheme.cuts[i]);
+    }
+    write(row + "\n");
+}
+
+void JsonSink::begin(const CuttingResult &result) {
+    write("{\"total_stock\":" + number(result.totalStockLength) + ",\"used_stock\":" + number(result.usedStockLength)
+          + ",\"stock_lower_bound\":" + number(result.stockLowerBound)
+          + ",\"stock_cost\":" + number(result.stockCost) + ",\"stock_cost_lower_bound\":" + number(result.stockCostLowerBound)
+          + ",\"stopped_early\":" + (result.stoppedEarly ? "true" : "false") + ",\"shortages\":[");
+    inSchemes = false;
+    firstItem = true;
+}
+
+void JsonSink::shortage(const Shortage &shortage) {
+    write(std::string(firstItem ? "\n" : ",\n") + "{\"profile\":" + jsonString(shortage.profileName)
+          + ",\"length\":" + number(shortage.lengthToCut) + ",\"quantity\":" + std::to_string(shortage.quantity)
+          + ",\"no_stock\":" + (shortage.noStock ? "true" : "false") + "}");
+    firstItem = false;
+}
+
+void JsonSink::scheme(const CuttingScheme &scheme) {
+    if (!inSchemes) {
+        write("],\"schemes\":[");
+        inSchemes = true;
+        firstItem = true;
+    }
+    std::string item = std::string(firstItem ? "\n" : ",\n") + "{\"profile\":" + jsonString(scheme.profileName)
+                       + ",\"count\":" + std::to_string(scheme.count) + ",\"stock_length\":" + number(scheme.stockLength)
+                       + ",\"remainder\":" + number(scheme.remainder)
+                       + ",\"offcut\":" + (scheme.fromRemnant ? "true" : "false") + ",\"cuts\":[";
+    for (std::size_t i = 0; i < scheme.cuts.size(); ++i) {
+        if (i > 0)
+            item += ',';
+        item += number(scheme.cuts[i]);
+    }
+    write(item + "]}");
+    firstItem = false;
+}
+
+void JsonSink::end(const CuttingResult &) {
+    write(inSchemes ? "]}\n" : "],\"schemes\":[]}\n");
+    flush();
+}
+
+void CuttingListSink::scheme(const CuttingScheme &scheme) {
+    std::string cuts = ";" + csvField(scheme.profileName, ';') + ";" + number(scheme.stockLength);
+    for (double cut : scheme.cuts)
+        cuts += ";" + number(cut);
+    cuts += "\n";
+    for (int c = 0; c < scheme.count; ++c)
+        write((scheme.fromRemnant ? "R" : "") + std::to_string(++bar) + cuts);
+}
+
+ResultFormat resultFormatOf(const std::string &fileName) {
+    for (ResultFormat format : {ResultFormat::Binary, ResultFormat::Csv, ResultFormat::Json, ResultFormat::CuttingList}) {
+        const std::string extension = resultFormatExtension(format);
+        if (fileName.size() >= extension.size()
+            && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0)
+            return format;
+    }
+    return ResultFormat::Report;
+}
+
+const char *resultFormatExtension(ResultFormat format) {
+    switch (format) {
+    case ResultFormat::Report:
+        return ".txt";
+    case ResultFormat::Binary:
+        return binaryResultExtension;
+    case ResultFormat::Csv:
+        return ".csv";
+    case ResultFormat::Json:
+        return ".json";
+    case ResultFormat::CuttingList:
+        return ".cutlist";
+    }
+    return ".txt";
+}
+
+bool parseResultFormat(const std::string &name, ResultFormat &format) {
+    if (name == "text" || name == "report")
+        format = ResultFormat::Report;
+    else if (name == "binary")
+        format = ResultFormat::Binary;
+    else if (name == "csv")
+        format = ResultFormat::Csv;
+    else if (name == "json")
+        format = ResultFormat::Json;
+    else if (name == "cutlist")
+        format = ResultFormat::CuttingList;
+    else
+        return false;
+    return true;
+}
+
+bool saveResultFile(const std::string &fileName, const CuttingResult &result, ResultFormat format,
+                    std::string *errorMessage) {
+    // The binary format is laid out like the result already is in memory
+    if (format == ResultFormat::Binary)
+        return writeFile(fileName, serializeResult(result), errorMessage);
+
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+    if (!file) {
+        if (errorMessage)
+            *errorMessage = "Cannot save file: " + fileName + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    bool ok = true;
+    auto output = [file, &ok](const char *data, std::size_t size) {
+        ok = ok && std::fwrite(data, 1, size, file) == size;
+    };
+    switch (format) {
+    case ResultFormat::Csv: {
+        CsvSink sink(output);
+        writeCuttingResult(result, sink);
+        break;
+    }
+    case ResultFormat::Json: {
+        JsonSink sink(output);
+        writeCuttingResult(result, sink);
+        break;
+    }
+    case ResultFormat::CuttingList: {
+        CuttingListSink sink(output);
+        writeCuttingResult(result, sink);
+        break;
+    }
+    default: {
+        const char header[] = "Cutting Scheme:\n";
+        output(header, sizeof(header) - 1);
+        ReportSink sink(output);
+        writeCuttingResult(result, sink);
+        break;
+    }
+    }
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok && errorMessage)
+        *errorMessage = "Cannot save file: " + fileName;
+    return ok;
+}
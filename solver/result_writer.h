@@ -0,0 +1,106 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+// Writing a plan out a piece at a time. A sink is handed the shortages and
+// schemes of a result one by one and passes its output on in chunks of a fixed
+// size, so no report, export or file is ever held whole in memory, however
+// many bars the plan cuts.
+
+#include "cutting_solver.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    // In this order: begin, every shortage, every scheme, end
+    virtual void begin(const CuttingResult &) {}
+    virtual void shortage(const Shortage &) {}
+    virtual void scheme(const CuttingScheme &scheme) = 0;
+    virtual void end(const CuttingResult &) {}
+};
+
+void writeCuttingResult(const CuttingResult &result, ResultSink &sink);
+
+// Base of the sinks that make text. Output is buffered and handed on whenever
+// a chunk is full, and at the end.
+class TextResultSink : public ResultSink {
+public:
+    using Output = std::function<void(const char *data, std::size_t size)>;
+    static const std::size_t chunkSize = 64 * 1024;
+
+    explicit TextResultSink(Output output) : output(std::move(output)) {}
+    void end(const CuttingResult &) override { flush(); }
+
+protected:
+    void write(const std::string &text);
+    void flush();
+
+private:
+    Output output;
+    std::string buffer;
+};
+
+// The human readable report of formatCuttingResult
+class ReportSink : public TextResultSink {
+public:
+    using TextResultSink::TextResultSink;
+    void shortage(const Shortage &shortage) override;
+    void scheme(const CuttingScheme &scheme) override;
+    void end(const CuttingResult &result) override;
+};
+
+// One row per scheme: profile, count, stock length, remainder, offcut (0 or 1)
+// and the cuts separated by spaces. Shortages are not part of it.
+class CsvSink : public TextResultSink {
+public:
+    using TextResultSink::TextResultSink;
+    void begin(const CuttingResult &result) override;
+    void scheme(const CuttingScheme &scheme) override;
+};
+
+// The whole result as one JSON object
+class JsonSink : public TextResultSink {
+public:
+    using TextResultSink::TextResultSink;
+    void begin(const CuttingResult &result) override;
+    void shortage(const Shortage &shortage) override;
+    void scheme(const CuttingScheme &scheme) override;
+    void end(const CuttingResult &result) override;
+
+private:
+    bool inSchemes = false;
+    bool firstItem = true;
+};
+
+// Cut list for a saw: one line per bar, with the counts spelled out, as
+// <bar>;<profile>;<stock length>;<cut>;<cut>... Offcuts are marked with an R
+// before the bar number.
+class CuttingListSink : public TextResultSink {
+public:
+    using TextResultSink::TextResultSink;
+    void scheme(const CuttingScheme &scheme) override;
+
+private:
+    long long bar = 0;
+};
+
+enum class ResultFormat {
+    Report,       // .txt and anything else
+    Binary,       // .cutres, the only one that loads back
+    Csv,          // .csv
+    Json,         // .json
+    CuttingList   // .cutlist
+};
+
+ResultFormat resultFormatOf(const std::string &fileName);
+const char *resultFormatExtension(ResultFormat format);
+bool parseResultFormat(const std::string &name, ResultFormat &format);
+
+bool saveResultFile(const std::string &fileName, const CuttingResult &result, ResultFormat format,
+                    std::string *errorMessage = nullptr);
+
+#endif // RESULT_WRITER_H
@@ -0,0 +1,111 @@
+#ifndef ROOM_INDEX_H
+#define ROOM_INDEX_H
+
+// Internal to the solver: the index best fit decreasing finds the fullest open
+// bar that still takes a piece with.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The set of room cells that hold at least one open bar, with the bars of each
+// cell in a singly linked list. Level 0 has one bit per cell, every level above
+// one bit per non-empty word of the level below.
+class RoomIndex {
+public:
+    static constexpr std::size_t none = static_cast<std::size_t>(-1);
+
+    explicit RoomIndex(std::size_t cells) : heads(cells, noBar) {
+        std::size_t bits = cells;
+        do {
+            levels.emplace_back((bits + 63) / 64, 0);
+            bits = levels.back().size();
+        } while (bits > 1);
+    }
+
+    void push(std::size_t cell, std::uint32_t bar) {
+        if (bar >= nextBar.size())
+            nextBar.resize(bar + 1, noBar);
+        nextBar[bar] = heads[cell];
+        if (heads[cell] == noBar)
+            setBit(cell);
+        heads[cell] = bar;
+    }
+
+    std::uint32_t pop(std::size_t cell) {
+        std::uint32_t bar = heads[cell];
+        heads[cell] = nextBar[bar];
+        if (heads[cell] == noBar)
+            clearBit(cell);
+        return bar;
+    }
+
+    // First non-empty cell at or after `cell`
+    std::size_t next(std::size_t cell) const {
+        if (cell >= heads.size())
+            return none;
+        std::size_t level = 0;
+        std::size_t index = cell;
+        while (true) {
+            const std::vector<std::uint64_t> &words = levels[level];
+            const std::size_t word = index / 64;
+            if (word >= words.size())
+                return none;
+            const std::uint64_t bits = words[word] & (~std::uint64_t(0) << (index % 64));
+            if (bits) {
+                index = word * 64 + lowestBit(bits);
+                break;
+            }
+            if (++level == levels.size())
+                return none;
+            index = word + 1;
+        }
+        while (level > 0) {
+            --level;
+            index = index * 64 + lowestBit(levels[level][index]);
+        }
+        return index;
+    }
+
+private:
+    static constexpr std::uint32_t noBar = ~std::uint32_t(0);
+
+    static int lowestBit(std::uint64_t bits) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    void setBit(std::size_t index) {
+        for (auto &words : levels) {
+            const bool wasEmpty = words[index / 64] == 0;
+            words[index / 64] |= std::uint64_t(1) << (index % 64);
+            if (!wasEmpty)
+                return;
+            index /= 64;
+        }
+    }
+
+    void clearBit(std::size_t index) {
+        for (auto &words : levels) {
+            words[index / 64] &= ~(std::uint64_t(1) << (index % 64));
+            if (words[index / 64] != 0)
+                return;
+            index /= 64;
+        }
+    }
+
+    std::vector<std::vector<std::uint64_t>> levels;
+    std::vector<std::uint32_t> heads;    // First bar of each cell
+    std::vector<std::uint32_t> nextBar;  // Next bar in the same cell
+};
+
+#endif // ROOM_INDEX_H
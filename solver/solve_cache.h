@@ -0,0 +1,62 @@
+#ifndef SOLVE_CACHE_H
+#define SOLVE_CACHE_H
+
+// Internal to the solver: what a SolveCache keeps from one solve for the next,
+// which is also what a checkpoint file holds.
+
+#include "cut_pattern.h"
+#include "cutting_solver.h"
+#include "length.h"
+#include "profile_group.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The cutting plan of one profile group, with what it leaves uncut
+struct GroupPlan {
+    std::vector<GroupScheme> schemes;
+    std::vector<std::pair<Length, int>> uncut;  // Length and quantity the plan does not cover
+    bool noStock = false;
+    int missingPieces = 0;
+    Length stockUsed = 0;  // Cost of the bars cut, see StockClass::cost
+};
+
+// One profile group as the last solve saw and left it
+struct SolveCache::State {
+    // A local search between two rounds: its bars in the order it holds them,
+    // one scheme each with the cuts unsorted, and its random state
+    struct Search {
+        std::uint64_t random = 0;
+        std::vector<GroupScheme> bars;
+    };
+
+    struct Group {
+        std::vector<StockClass> stock;
+        std::vector<std::pair<Length, int>> lengthsToCut;  // Before any offcut is cut
+        std::vector<Length> remnants;
+        std::vector<Length> pieceLengths;
+        Length stockLowerBound = 0;
+        GroupPlan plan;
+        bool final = false;  // Solved to the end, not stopped early
+
+        // Where a solve that did not finish the group left off
+        std::vector<GroupScheme> patterns;  // Column generation's pattern pool, count unused
+        int searchRounds = 0;               // Local search rounds done by `searches`
+        std::vector<Search> searches;
+    };
+
+    // The settings the plans were found with
+    SolverMode mode = SolverMode::Greedy;
+    double lengthUnit = 0.0;
+    std::uint64_t seed = 0;
+    unsigned searchStarts = 0;
+    int searchMoves = 0;
+    bool remnants = false;
+
+    std::map<std::string, Group> groups;
+};
+
+#endif // SOLVE_CACHE_H
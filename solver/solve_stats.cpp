@@ -0,0 +1,175 @@
+#include "solve_stats.h"
+#include "binary_format.h"
+#include "text_escape.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+long long processPeakMemoryKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+namespace {
+
+std::string number(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6f", value);
+    return buffer;
+}
+
+// Total time and count of every phase name, in order of first appearance
+std::vector<std::pair<std::string, std::pair<int, double>>> phaseTotals(const std::vector<SolveStats::Phase> &phases) {
+    std::vector<std::pair<std::string, std::pair<int, double>>> totals;
+    std::map<std::string, std::size_t> index;
+    for (const auto &phase : phases) {
+        auto inserted = index.emplace(phase.name, totals.size());
+        if (inserted.second)
+            totals.push_back({phase.name, {0, 0.0}});
+        auto &total = totals[inserted.first->second].second;
+        ++total.first;
+        total.second += phase.seconds;
+    }
+    return totals;
+}
+
+} // namespace
+
+const char *counterName(SolveStats::Counter counter) {
+    switch (counter) {
+    case SolveStats::PatternsGenerated:
+        return "patterns_generated";
+    case SolveStats::BarsOpened:
+        return "bars_opened";
+    case SolveStats::ImprovementIterations:
+        return "improvement_iterations";
+    case SolveStats::GroupsReused:
+        return "groups_reused";
+    case SolveStats::counterCount:
+        break;
+    }
+    return "unknown";
+}
+
+SolveStats::SolveStats() {
+    clear();
+}
+
+void SolveStats::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    origin = std::chrono::steady_clock::now();
+    phaseList.clear();
+    threads.clear();
+    for (auto &counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+void SolveStats::record(const char *name, const char *detail, std::chrono::steady_clock::time_point begin,
+                        std::chrono::steady_clock::time_point end) {
+    const long long memory = ::processPeakMemoryKb();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto thread = threads.emplace(std::this_thread::get_id(), static_cast<unsigned>(threads.size() + 1)).first->second;
+    phaseList.push_back({name, detail, std::chrono::duration<double>(begin - origin).count(),
+                         std::chrono::duration<double>(end - begin).count(), thread, memory});
+}
+
+std::vector<SolveStats::Phase> SolveStats::phases() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return phaseList;
+}
+
+long long SolveStats::processPeakMemoryKb() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long peak = 0;
+    for (const auto &phase : phaseList)
+        peak = std::max(peak, phase.processPeakMemoryKb);
+    return peak;
+}
+
+std::string SolveStats::toJson() const {
+    std::vector<Phase> all = phases();
+    std::string json = "{\"process_peak_memory_kb\":" + std::to_string(processPeakMemoryKb()) + ",\"counters\":{";
+    for (int c = 0; c < counterCount; ++c) {
+        if (c > 0)
+            json += ",";
+        json += jsonString(counterName(static_cast<Counter>(c))) + ":" + std::to_string(count(static_cast<Counter>(c)));
+    }
+    json += "},\"phases\":{";
+    bool first = true;
+    for (const auto &total : phaseTotals(all)) {
+        if (!first)
+            json += ",";
+        first = false;
+        json += jsonString(total.first) + ":{\"count\":" + std::to_string(total.second.first)
+                + ",\"seconds\":" + number(total.second.second) + "}";
+    }
+    return json + "}}\n";
+}
+
+std::string SolveStats::toChromeTrace() const {
+    std::vector<Phase> all = phases();
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &phase : all) {
+        if (!first)
+            json += ",\n";
+        first = false;
+        json += "{\"name\":" + jsonString(phase.name) + ",\"cat\":\"solver\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                + std::to_string(phase.thread) + ",\"ts\":" + number(phase.start * 1e6)
+                + ",\"dur\":" + number(phase.seconds * 1e6);
+        if (!phase.detail.empty())
+            json += ",\"args\":{\"detail\":" + jsonString(phase.detail) + "}";
+        json += "},\n{\"name\":\"process peak memory\",\"ph\":\"C\",\"pid\":1,\"ts\":" + number((phase.start + phase.seconds) * 1e6)
+                + ",\"args\":{\"kb\":" + std::to_string(phase.processPeakMemoryKb) + "}}";
+    }
+    return json + "]}\n";
+}
+
+std::string SolveStats::summary() const {
+    std::string text;
+    char line[128];
+    for (const auto &total : phaseTotals(phases())) {
+        std::snprintf(line, sizeof(line), "%-26s %9.3f ms  (%d)\n", total.first.c_str(), total.second.second * 1e3,
+                      total.second.first);
+        text += line;
+    }
+    for (int c = 0; c < counterCount; ++c) {
+        std::snprintf(line, sizeof(line), "%-26s %12llu\n", counterName(static_cast<Counter>(c)),
+                      static_cast<unsigned long long>(count(static_cast<Counter>(c))));
+        text += line;
+    }
+    std::snprintf(line, sizeof(line), "%-26s %9lld KiB\n", "process_peak_memory", processPeakMemoryKb());
+    return text + line;
+}
+
+bool SolveStats::saveJson(const std::string &fileName, std::string *errorMessage) const {
+    return writeFile(fileName, toJson(), errorMessage);
+}
+
+bool SolveStats::saveChromeTrace(const std::string &fileName, std::string *errorMessage) const {
+    return writeFile(fileName, toChromeTrace(), errorMessage);
+}
@@ -0,0 +1,102 @@
+#ifndef SOLVE_STATS_H
+#define SOLVE_STATS_H
+
+// Where the time of a solve goes: timed phases, work counters and the peak
+// memory of the process, for diagnosing slow jobs without a profiler. The
+// operating system only keeps the peak of the whole process, so it includes
+// whatever ran before the solve; a solve that stays below an earlier peak
+// does not show. Nothing is recorded unless a SolveStats is handed in; then
+// every phase costs two clock reads and a short locked append, and every
+// counter an atomic add.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Peak resident memory of the whole process so far, in KiB
+long long processPeakMemoryKb();
+
+class SolveStats {
+public:
+    enum Counter {
+        PatternsGenerated,      // Columns the pricing added to the LP
+        BarsOpened,             // Bars started by the fills and the searches
+        ImprovementIterations,  // LP iterations and local search moves
+        GroupsReused,           // Profiles kept unchanged from a cached solve
+        counterCount
+    };
+
+    struct Phase {
+        std::string name;
+        std::string detail;     // Usually the profile or file the phase worked on
+        double start;           // Seconds since the stats were cleared
+        double seconds;
+        unsigned thread;        // Small numbers in order of first use
+        long long processPeakMemoryKb;  // When the phase ended
+    };
+
+    SolveStats();
+
+    // Safe to call from any thread
+    void add(Counter counter, std::uint64_t amount = 1) { counters[counter].fetch_add(amount, std::memory_order_relaxed); }
+    void record(const char *name, const char *detail, std::chrono::steady_clock::time_point begin,
+                std::chrono::steady_clock::time_point end);
+
+    // Not while a solve is recording
+    void clear();
+    std::uint64_t count(Counter counter) const { return counters[counter].load(std::memory_order_relaxed); }
+    std::vector<Phase> phases() const;
+    long long processPeakMemoryKb() const;  // When the last phase ended
+
+    // Seconds per phase name and counters as one JSON object, the phases as
+    // complete events of the Chrome trace event format (chrome://tracing,
+    // Perfetto), and a short summary for people
+    std::string toJson() const;
+    std::string toChromeTrace() const;
+    std::string summary() const;
+    bool saveJson(const std::string &fileName, std::string *errorMessage = nullptr) const;
+    bool saveChromeTrace(const std::string &fileName, std::string *errorMessage = nullptr) const;
+
+private:
+    mutable std::mutex mutex;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<Phase> phaseList;
+    std::map<std::thread::id, unsigned> threads;
+    std::array<std::atomic<std::uint64_t>, counterCount> counters;
+};
+
+const char *counterName(SolveStats::Counter counter);
+
+// Times the enclosing scope as one phase. Does nothing without stats. Both
+// strings must outlive the timer.
+class PhaseTimer {
+public:
+    PhaseTimer(SolveStats *stats, const char *name, const char *detail = "") : stats(stats), name(name), detail(detail) {
+        if (stats)
+            begin = std::chrono::steady_clock::now();
+    }
+    ~PhaseTimer() { stop(); }
+
+    // End the phase before the scope does
+    void stop() {
+        if (stats)
+            stats->record(name, detail, begin, std::chrono::steady_clock::now());
+        stats = nullptr;
+    }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    SolveStats *stats;
+    const char *name;
+    const char *detail;
+    std::chrono::steady_clock::time_point begin;
+};
+
+#endif // SOLVE_STATS_H
@@ -0,0 +1,45 @@
+# Headless cutting solver. Plain C++17, no Qt dependency, so it can be shared
+# by the GUI, the batch command line tool and anything else that includes it.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/bar_fill.cpp \
+    $$PWD/best_fit.cpp \
+    $$PWD/binary_format.cpp \
+    $$PWD/chunked_solver.cpp \
+    $$PWD/column_generation.cpp \
+    $$PWD/cut_pattern.cpp \
+    $$PWD/cutting_job.cpp \
+    $$PWD/cutting_solver.cpp \
+    $$PWD/length.cpp \
+    $$PWD/local_search.cpp \
+    $$PWD/lower_bound.cpp \
+    $$PWD/mapped_file.cpp \
+    $$PWD/remnant_store.cpp \
+    $$PWD/result_writer.cpp \
+    $$PWD/solve_stats.cpp \
+    $$PWD/task_pool.cpp \
+    $$PWD/text_escape.cpp
+
+HEADERS += \
+    $$PWD/bar_fill.h \
+    $$PWD/binary_format.h \
+    $$PWD/chunked_solver.h \
+    $$PWD/cut_pattern.h \
+    $$PWD/cutting_job.h \
+    $$PWD/cutting_solver.h \
+    $$PWD/length.h \
+    $$PWD/local_search.h \
+    $$PWD/mapped_file.h \
+    $$PWD/profile_group.h \
+    $$PWD/remnant_store.h \
+    $$PWD/result_writer.h \
+    $$PWD/room_index.h \
+    $$PWD/solve_cache.h \
+    $$PWD/solve_stats.h \
+    $$PWD/task_pool.h \
+    $$PWD/text_escape.h
+
+win32: LIBS += -lpsapi
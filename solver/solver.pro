@@ -0,0 +1,6 @@
+# The solver as a static library, and its tests. Run them with `make check`.
+
+TEMPLATE = subdirs
+SUBDIRS = cuttingsolver tests
+
+cuttingsolver.file = cuttingsolver.pro
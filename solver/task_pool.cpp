@@ -0,0 +1,116 @@
+#include "task_pool.h"
+
+#include <algorithm>
+
+TaskPool::TaskPool(unsigned threadCount) : threads(threadCount) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+    // The calling thread of run() is worker 0
+    for (unsigned id = 1; id < threads; ++id)
+        workers.emplace_back(&TaskPool::workerLoop, this, id);
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+// Own queue from the front, where the biggest tasks are; otherwise steal the
+// smallest task from the back of another queue
+bool TaskPool::takeTask(unsigned worker, std::size_t &index) {
+    {
+        WorkQueue &own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            index = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (unsigned offset = 1; offset < threads; ++offset) {
+        WorkQueue &victim = *queues[(worker + offset) % threads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            index = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskPool::drain(unsigned worker, const std::function<void(std::size_t)> &task) {
+    std::size_t index;
+    while (takeTask(worker, index)) {
+        try {
+            task(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failure)
+                failure = std::current_exception();
+        }
+    }
+}
+
+void TaskPool::workerLoop(unsigned worker) {
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+        if (worker > joining)
+            continue;
+
+        const std::function<void(std::size_t)> &task = *current;
+        lock.unlock();
+        drain(worker, task);
+        lock.lock();
+        if (--busy == 0)
+            finished.notify_one();
+    }
+}
+
+void TaskPool::run(const std::vector<std::size_t> &order, const std::function<void(std::size_t)> &task) {
+    if (order.empty())
+        return;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        WorkQueue &queue = *queues[i % threads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(order[i]);
+    }
+
+    // No point waking more threads than there are tasks
+    const unsigned helpers = static_cast<unsigned>(std::min<std::size_t>(threads, order.size())) - 1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        failure = nullptr;
+        joining = helpers;
+        busy = helpers;
+        ++generation;
+    }
+    if (helpers > 0)
+        wake.notify_all();
+
+    drain(0, task);
+
+    std::exception_ptr thrown;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return busy == 0; });
+        current = nullptr;
+        thrown = failure;
+        failure = nullptr;
+    }
+    if (thrown)
+        std::rethrow_exception(thrown);
+}
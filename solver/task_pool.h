@@ -0,0 +1,63 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+// Internal to the solver: a small work-stealing pool for independent tasks of
+// very different sizes, such as the profile groups of one order. The worker
+// threads start with the pool and wait between runs, so a solve that runs
+// many short rounds does not start a thread per round.
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskPool {
+public:
+    explicit TaskPool(unsigned threadCount);  // 0 means one thread per core
+    ~TaskPool();
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    unsigned threadCount() const { return threads; }
+
+    // Run task(i) for every index in `order` and return when all have finished.
+    // Tasks are dealt out round-robin in the given order, so put the biggest
+    // first; a thread that runs out of work steals from the others. The calling
+    // thread takes part. The first exception thrown by a task is rethrown here.
+    // One run at a time: a task must not call run() on its own pool.
+    void run(const std::vector<std::size_t> &order, const std::function<void(std::size_t)> &task);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    bool takeTask(unsigned worker, std::size_t &index);
+    void drain(unsigned worker, const std::function<void(std::size_t)> &task);
+    void workerLoop(unsigned worker);
+
+    unsigned threads;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    // Hand-over between run() and the workers, guarded by `mutex`
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(std::size_t)> *current = nullptr;
+    std::uint64_t generation = 0;  // Counts runs, so a worker takes part in each once
+    unsigned joining = 0;          // Workers asked to take part in the current run
+    unsigned busy = 0;             // Of those, the ones not yet done
+    bool stopping = false;
+    std::exception_ptr failure;
+};
+
+#endif // TASK_POOL_H
@@ -0,0 +1,201 @@
+// Job, result, checkpoint and offcut store files: what is written reads back
+// the same, and damaged files are refused instead of misread.
+
+#include "binary_format.h"
+#include "remnant_store.h"
+#include "test.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string readFile(const std::string &fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+bool sameJob(const CuttingJob &a, const CuttingJob &b) {
+    if (a.stock.size() != b.stock.size() || a.cuts.size() != b.cuts.size())
+        return false;
+    for (std::size_t i = 0; i < a.stock.size(); ++i) {
+        const StockEntry &x = a.stock[i];
+        const StockEntry &y = b.stock[i];
+        if (x.profileName != y.profileName || x.quantity != y.quantity || x.length != y.length || x.cost != y.cost)
+            return false;
+    }
+    for (std::size_t i = 0; i < a.cuts.size(); ++i) {
+        const CutEntry &x = a.cuts[i];
+        const CutEntry &y = b.cuts[i];
+        if (x.profileName != y.profileName || x.quantity != y.quantity || x.lengthToCut != y.lengthToCut)
+            return false;
+    }
+    return true;
+}
+
+bool sameResult(const CuttingResult &a, const CuttingResult &b) {
+    if (a.schemes.size() != b.schemes.size() || a.shortages.size() != b.shortages.size()
+        || a.totalStockLength != b.totalStockLength || a.usedStockLength != b.usedStockLength
+        || a.stockLowerBound != b.stockLowerBound || a.stockCost != b.stockCost
+        || a.stockCostLowerBound != b.stockCostLowerBound || a.stoppedEarly != b.stoppedEarly)
+        return false;
+    for (std::size_t i = 0; i < a.schemes.size(); ++i) {
+        const CuttingScheme &x = a.schemes[i];
+        const CuttingScheme &y = b.schemes[i];
+        if (x.profileName != y.profileName || x.stockLength != y.stockLength || x.cuts != y.cuts
+            || x.remainder != y.remainder || x.count != y.count || x.fromRemnant != y.fromRemnant)
+            return false;
+    }
+    for (std::size_t i = 0; i < a.shortages.size(); ++i) {
+        const Shortage &x = a.shortages[i];
+        const Shortage &y = b.shortages[i];
+        if (x.profileName != y.profileName || x.lengthToCut != y.lengthToCut || x.quantity != y.quantity
+            || x.noStock != y.noStock)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(textJobRoundTrip) {
+    const CuttingJob job = randomJob(1, 3, 12, 1.2);
+    const std::string fileName = temporaryFile("round.txt");
+    std::string errorMessage;
+    REQUIRE(saveJobFile(fileName, job, &errorMessage));
+    CuttingJob loaded;
+    REQUIRE(loadJobFile(fileName, loaded, &errorMessage));
+    CHECK(sameJob(job, loaded));
+}
+
+TEST(binaryJobRoundTrip) {
+    const CuttingJob job = randomJob(2, 3, 12, 1.2);
+    const std::string fileName = temporaryFile(std::string("round") + binaryJobExtension);
+    std::string errorMessage;
+    REQUIRE(saveJobFile(fileName, job, &errorMessage));
+    const std::string data = readFile(fileName);
+    CHECK(isBinaryJob(data.data(), data.size()));
+    CuttingJob loaded;
+    REQUIRE(loadJobFile(fileName, loaded, &errorMessage));
+    CHECK(sameJob(job, loaded));
+
+    // Either format parses from memory too
+    CuttingJob parsed;
+    CHECK(parseJob(data.data(), data.size(), parsed, &errorMessage) && sameJob(job, parsed));
+}
+
+TEST(truncatedBinaryJobIsRefused) {
+    const std::string data = serializeJob(randomJob(3, 2, 8, 1.0));
+    for (std::size_t size = 0; size < data.size(); size += 7) {
+        CuttingJob job;
+        std::string errorMessage;
+        CHECK(!parseBinaryJob(data.data(), size, job, &errorMessage));
+        CHECK(!errorMessage.empty());
+    }
+}
+
+TEST(badTextJobNamesTheLine) {
+    const std::string text = "Stock Table:\nP,2,6000\nProfile Table:\nP,1200,3\nP,abc,1\n";
+    CuttingJob job;
+    std::string errorMessage;
+    CHECK(!parseJobText(text.data(), text.size(), job, &errorMessage));
+    CHECK(errorMessage.find('5') != std::string::npos);
+}
+
+TEST(jobReaderReadsEveryRow) {
+    const CuttingJob job = randomJob(4, 4, 20, 1.1);
+    for (const char *extension : {".txt", binaryJobExtension}) {
+        const std::string fileName = temporaryFile(std::string("reader") + extension);
+        REQUIRE(saveJobFile(fileName, job));
+        JobReader reader;
+        std::string errorMessage;
+        REQUIRE(reader.open(fileName, &errorMessage));
+        CuttingJob read;
+        read.stock = reader.stock();
+        while (!reader.atEnd())
+            reader.readCuts(25, read.cuts);
+        CHECK(sameJob(job, read));
+    }
+}
+
+TEST(binaryResultRoundTrip) {
+    const CuttingJob job = randomJob(5, 3, 15, 0.8);
+    SolverOptions options;
+    options.mode = SolverMode::BestFit;
+    const CuttingResult result = solveCuttingJob(job, options);
+    REQUIRE(!result.shortages.empty());
+
+    const std::string fileName = temporaryFile(std::string("round") + binaryResultExtension);
+    std::string errorMessage;
+    REQUIRE(saveResultFile(fileName, result, &errorMessage));
+    CuttingResult loaded;
+    REQUIRE(loadResultFile(fileName, loaded, &errorMessage));
+    CHECK(sameResult(result, loaded));
+
+    const std::string data = readFile(fileName);
+    for (std::size_t size = 0; size < data.size(); size += 13) {
+        CuttingResult damaged;
+        CHECK(!parseBinaryResult(data.data(), size, damaged, &errorMessage));
+    }
+}
+
+TEST(checkpointRoundTrip) {
+    const CuttingJob job = randomJob(6, 2, 10, 1.3);
+    SolverOptions options;
+    options.mode = SolverMode::LocalSearch;
+    options.searchStarts = 2;
+    options.searchMoves = 500;
+    SolveCache cache;
+    options.cache = &cache;
+    const CuttingResult first = solveCuttingJob(job, options);
+
+    const std::string fileName = temporaryFile(std::string("round") + checkpointExtension);
+    const std::string again = temporaryFile(std::string("again") + checkpointExtension);
+    std::string errorMessage;
+    REQUIRE(cache.save(fileName, &errorMessage));
+    SolveCache loaded;
+    REQUIRE(loaded.load(fileName, &errorMessage));
+    REQUIRE(loaded.save(again, &errorMessage));
+    CHECK(readFile(fileName) == readFile(again));
+
+    // A solve from the loaded checkpoint finds every profile unchanged
+    options.cache = &loaded;
+    CHECK(sameResult(first, solveCuttingJob(job, options)));
+
+    const std::string data = readFile(fileName);
+    SolveCache damaged;
+    const std::string cut = temporaryFile(std::string("cut") + checkpointExtension);
+    std::ofstream(cut, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size() / 2));
+    CHECK(!damaged.load(cut, &errorMessage));
+}
+
+TEST(offcutStoreRoundTrip) {
+    const std::string fileName = temporaryFile(std::string("yard") + remnantStoreExtension);
+    RemnantStore store;
+    REQUIRE(store.open(fileName));  // Not there yet, so empty
+    CHECK(store.size() == 0);
+    store.close();
+
+    CuttingResult result;
+    result.schemes.push_back({"B", 6000.0, {2000.0, 1500.0}, 2500.0, 2, false, {}});
+    result.schemes.push_back({"A", 6000.0, {5000.0}, 1000.0, 1, false, {}});
+    result.schemes.push_back({"A", 6000.0, {5800.0}, 200.0, 3, false, {}});
+    std::string errorMessage;
+    REQUIRE(RemnantStore::update(fileName, result, 500.0, &errorMessage));
+
+    REQUIRE(store.open(fileName, &errorMessage));
+    CHECK(store.size() == 3);
+    CHECK(std::vector<double>(store.begin("A"), store.end("A")) == std::vector<double>{1000.0});
+    CHECK(std::vector<double>(store.begin("B"), store.end("B")) == (std::vector<double>{2500.0, 2500.0}));
+    CHECK(store.begin("C") == store.end("C"));
+    CHECK(store.shortestAtLeast("B", 2000.0) == 2500.0);
+    CHECK(store.shortestAtLeast("B", 3000.0) == 0.0);
+    store.close();
+
+    const std::string data = readFile(fileName);
+    const std::string cut = temporaryFile(std::string("cut") + remnantStoreExtension);
+    std::ofstream(cut, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size() - 4));
+    CHECK(!store.open(cut, &errorMessage));
+}
@@ -0,0 +1,112 @@
+// The inner kernels against plain reference versions: the room index of best
+// fit decreasing, and the bar filler with its AVX2 and portable bitset steps.
+
+#include "bar_fill.h"
+#include "room_index.h"
+#include "test.h"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+TEST(roomIndexFindsTheNextCell) {
+    std::mt19937_64 random(11);
+    for (std::size_t cells : {1, 63, 64, 4097, 300000}) {
+        RoomIndex index(cells);
+        std::multiset<std::size_t> reference;
+        std::vector<std::set<std::uint32_t>> barsIn(cells);
+        std::uniform_int_distribution<std::size_t> cell(0, cells - 1);
+        std::uint32_t nextBar = 0;
+        for (int step = 0; step < 20000; ++step) {
+            const std::size_t at = cell(random);
+            if (random() % 3 != 0 || reference.empty()) {
+                index.push(at, nextBar);
+                barsIn[at].insert(nextBar++);
+                reference.insert(at);
+            } else {
+                // Pop from the cell a successor query finds, as best fit does
+                const std::size_t found = index.next(at);
+                auto expected = reference.lower_bound(at);
+                REQUIRE((found == RoomIndex::none) == (expected == reference.end()));
+                if (found == RoomIndex::none)
+                    continue;
+                REQUIRE(found == *expected);
+                const std::uint32_t bar = index.pop(found);
+                CHECK(barsIn[found].erase(bar) == 1);
+                reference.erase(reference.find(found));
+            }
+        }
+        CHECK(index.next(cells) == RoomIndex::none);
+    }
+}
+
+TEST(vectorAndPortableShiftsAgree) {
+    std::mt19937_64 random(12);
+    for (int round = 0; round < 2000; ++round) {
+        const std::size_t words = 1 + random() % 40;
+        std::vector<std::uint64_t> bits(words);
+        for (auto &word : bits)
+            word = random() & random();
+        const std::size_t shift = random() % (64 * words + 70);
+        std::vector<std::uint64_t> fast = bits;
+        std::vector<std::uint64_t> plain = bits;
+        std::vector<std::uint64_t> fastAdded(words);
+        std::vector<std::uint64_t> plainAdded(words);
+        shiftReachable(fast.data(), words, shift, fastAdded.data());
+        shiftReachable(plain.data(), words, shift, plainAdded.data(), true);
+        CHECK(fast == plain);
+        CHECK(fastAdded == plainAdded);
+
+        // Against one bit at a time
+        std::vector<std::uint64_t> expected = bits;
+        for (std::size_t from = 0; from + shift < 64 * words; ++from) {
+            if (bits[from / 64] >> (from % 64) & 1)
+                expected[(from + shift) / 64] |= std::uint64_t(1) << ((from + shift) % 64);
+        }
+        CHECK(plain == expected);
+    }
+}
+
+TEST(barFillIsTheFullest) {
+    std::mt19937_64 random(13);
+    for (int round = 0; round < 300; ++round) {
+        std::vector<Length> lengths;
+        std::set<Length, std::greater<Length>> distinct;
+        while (distinct.size() < 1 + random() % 6)
+            distinct.insert(static_cast<Length>(50 + random() % 900));
+        lengths.assign(distinct.begin(), distinct.end());
+        std::vector<int> limits;
+        for (std::size_t i = 0; i < lengths.size(); ++i)
+            limits.push_back(static_cast<int>(random() % 5));
+        const Length capacity = static_cast<Length>(500 + random() % 3000);
+
+        BarFiller filler(lengths, {capacity});
+        std::vector<int> counts;
+        const Length used = filler.fill(limits, capacity, counts);
+
+        Length total = 0;
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            CHECK(counts[i] >= 0 && counts[i] <= limits[i]);
+            total += counts[i] * lengths[i];
+        }
+        CHECK(total == used);
+        CHECK(used <= capacity);
+
+        // Bounded subset sum, one piece at a time
+        std::vector<char> reachable(static_cast<std::size_t>(capacity) + 1, 0);
+        reachable[0] = 1;
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            for (int c = 0; c < limits[i]; ++c) {
+                for (Length at = capacity; at >= lengths[i]; --at)
+                    reachable[at] = reachable[at] || reachable[at - lengths[i]];
+            }
+        }
+        Length best = capacity;
+        while (!reachable[best])
+            --best;
+        CHECK(used == best);
+    }
+}
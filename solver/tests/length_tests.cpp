@@ -0,0 +1,89 @@
+// Length rounding: pieces round up and bars down, so a plan never counts on
+// more than a bar holds, and plans report the job's own lengths.
+
+#include "length.h"
+#include "test.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(lengthsRoundTheSafeWay) {
+    const LengthUnit unit(0.1);
+    CHECK(unit.pieceFromJob(1200.0) == 12000);
+    CHECK(unit.barFromJob(6000.0) == 60000);
+    CHECK(unit.pieceFromJob(1200.05) == 12001);
+    CHECK(unit.barFromJob(6000.05) == 60000);
+    CHECK(unit.toJob(12001) == 1200.1);
+
+    // Decimal lengths that are not exact in binary still land on their cell
+    const LengthUnit hundredths(0.01);
+    CHECK(hundredths.pieceFromJob(0.29) == 29);
+    CHECK(hundredths.barFromJob(0.29) == 29);
+    CHECK(hundredths.pieceFromJob(1234.56) == 123456);
+    CHECK(hundredths.barFromJob(1234.56) == 123456);
+}
+
+TEST(lengthGridIsTheCoarsestThatFits) {
+    LengthGrid grid;
+    CHECK(grid.unit() == 0.1);
+    grid.add(6000.0);
+    grid.add(1200.5);
+    CHECK(grid.unit() == 0.1);
+    grid.add(99.25);
+    CHECK(grid.unit() == 0.01);
+    grid.add(0.125);
+    CHECK(grid.unit() == 0.001);
+    grid.add(0.0001);
+    CHECK(grid.unit() == 0.001);
+}
+
+TEST(handOutBarsGivesBackTheJobLengths) {
+    // 1000.04 and 1000.06 both round up to 1000.1 on a 0.1 grid
+    const LengthUnit unit(0.1);
+    JobLengths stock(unit);
+    JobLengths pieces(unit);
+    stock.add(unit.barFromJob(3000.0), 3000.0, 3);
+    pieces.add(unit.pieceFromJob(1000.04), 1000.04, 4);
+    pieces.add(unit.pieceFromJob(1000.06), 1000.06, 2);
+    const Length piece = unit.pieceFromJob(1000.04);
+    REQUIRE(piece == unit.pieceFromJob(1000.06));
+
+    std::map<double, int> cut;
+    int bars = 0;
+    handOutBars(stock, pieces, unit.barFromJob(3000.0), {piece, piece}, 3,
+                [&](double stockLength, const std::vector<double> &cuts, int count) {
+                    CHECK(stockLength == 3000.0);
+                    CHECK(std::is_sorted(cuts.rbegin(), cuts.rend()));
+                    bars += count;
+                    for (double length : cuts)
+                        cut[length] += count;
+                });
+    CHECK(bars == 3);
+    CHECK(cut[1000.06] == 2);
+    CHECK(cut[1000.04] == 4);
+    CHECK(cut.size() == 2);
+
+    // Given out in full, a length is its solver length again
+    CHECK(pieces.next(piece).first == unit.toJob(piece));
+}
+
+TEST(solvedPlansKeepTheJobLengths) {
+    CuttingJob job;
+    job.stock.push_back({"P", 10, 6000.0, 0.0});
+    job.cuts.push_back({"P", 1999.96, 3});
+    job.cuts.push_back({"P", 1999.99, 3});
+    job.cuts.push_back({"P", 1500.004, 4});
+    for (SolverMode mode : {SolverMode::Greedy, SolverMode::BestFit, SolverMode::ColumnGeneration,
+                            SolverMode::LocalSearch}) {
+        SolverOptions options;
+        options.mode = mode;
+        options.lengthUnit = 0.1;
+        options.searchStarts = 1;
+        const CuttingResult result = solveCuttingJob(job, options);
+        CHECK(planProblem(job, result).empty());
+        CHECK(result.shortages.empty());
+    }
+}
@@ -0,0 +1,146 @@
+// Solver tests: runs every registered test, or those whose names contain one
+// of the arguments, and exits non-zero when any check fails.
+
+#include "test.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Test {
+    const char *name;
+    void (*run)();
+};
+
+std::vector<Test> &tests() {
+    static std::vector<Test> all;
+    return all;
+}
+
+int failures = 0;
+std::filesystem::path directory;
+
+} // namespace
+
+void registerTest(const char *name, void (*run)()) {
+    tests().push_back({name, run});
+}
+
+void reportFailure(const char *file, int line, const std::string &message) {
+    std::cerr << file << ":" << line << ": check failed: " << message << "\n";
+    ++failures;
+}
+
+std::string temporaryFile(const std::string &name) {
+    if (directory.empty()) {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+        directory = std::filesystem::temp_directory_path() / ("solver_tests_" + std::to_string(now));
+        std::filesystem::create_directories(directory);
+    }
+    return (directory / name).string();
+}
+
+CuttingJob randomJob(std::uint64_t seed, int profiles, int lengths, double stockShare) {
+    std::mt19937_64 random(seed);
+    auto uniform = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(random); };
+    CuttingJob job;
+    for (int p = 0; p < profiles; ++p) {
+        const std::string name = "P" + std::to_string(p);
+        double pieceLength = 0.0;
+        for (int i = 0; i < lengths; ++i) {
+            // Tenths of a mm and odd hundredths now and then, so lengths fall off the grid
+            double length = uniform(2000, 55000) / 10.0;
+            if (uniform(0, 7) == 0)
+                length += 0.05;
+            const int quantity = uniform(1, 30);
+            job.cuts.push_back({name, length, quantity});
+            pieceLength += length * quantity;
+        }
+        const double bars[] = {6000.0, 7500.0, 12000.0};
+        const int kinds = uniform(1, 3);
+        for (int k = 0; k < kinds; ++k) {
+            const double stockLength = bars[k];
+            const int quantity = std::max(1, static_cast<int>(std::ceil(pieceLength * stockShare / kinds / stockLength)));
+            const double cost = uniform(0, 1) ? stockLength / 1000.0 * uniform(8, 12) : 0.0;
+            job.stock.push_back({name, quantity, stockLength, cost});
+        }
+    }
+    return job;
+}
+
+std::string planProblem(const CuttingJob &job, const CuttingResult &result) {
+    std::map<std::pair<std::string, double>, long long> stockLeft;
+    std::map<std::pair<std::string, double>, long long> piecesLeft;
+    std::map<std::string, bool> hasStock;
+    for (const StockEntry &stock : job.stock) {
+        stockLeft[{stock.profileName, stock.length}] += stock.quantity;
+        hasStock[stock.profileName] = hasStock[stock.profileName] || stock.quantity > 0;
+    }
+    for (const CutEntry &cut : job.cuts)
+        piecesLeft[{cut.profileName, cut.lengthToCut}] += cut.quantity;
+
+    for (const CuttingScheme &scheme : result.schemes) {
+        if (scheme.count <= 0)
+            return "a scheme of " + scheme.profileName + " cuts no bars";
+        double used = 0.0;
+        for (double cut : scheme.cuts) {
+            used += cut;
+            if ((piecesLeft[{scheme.profileName, cut}] -= scheme.count) < 0)
+                return "more pieces of " + std::to_string(cut) + " cut than " + scheme.profileName + " asks for";
+        }
+        if (used > scheme.stockLength + 1e-6)
+            return "a bar of " + scheme.profileName + " is cut beyond its length";
+        if (std::abs(scheme.stockLength - used - scheme.remainder) > 1e-6)
+            return "a scheme of " + scheme.profileName + " gives the wrong remainder";
+        if (!scheme.fromRemnant && (stockLeft[{scheme.profileName, scheme.stockLength}] -= scheme.count) < 0)
+            return "more bars of " + std::to_string(scheme.stockLength) + " cut than " + scheme.profileName + " has";
+    }
+    for (const Shortage &shortage : result.shortages) {
+        if (shortage.noStock) {
+            if (hasStock[shortage.profileName])
+                return shortage.profileName + " is reported without stock but has some";
+            for (auto &pieces : piecesLeft) {
+                if (pieces.first.first == shortage.profileName)
+                    pieces.second = 0;
+            }
+        } else {
+            piecesLeft[{shortage.profileName, shortage.lengthToCut}] -= shortage.quantity;
+        }
+    }
+    for (const auto &pieces : piecesLeft) {
+        if (pieces.second != 0)
+            return std::to_string(pieces.second) + " pieces of " + std::to_string(pieces.first.second) + " of "
+                   + pieces.first.first + " are neither cut nor short";
+    }
+    return std::string();
+}
+
+int main(int argc, char *argv[]) {
+    int run = 0;
+    for (const Test &test : tests()) {
+        bool wanted = argc < 2;
+        for (int i = 1; i < argc && !wanted; ++i)
+            wanted = std::string(test.name).find(argv[i]) != std::string::npos;
+        if (!wanted)
+            continue;
+        const int before = failures;
+        test.run();
+        std::cout << (failures == before ? "ok    " : "FAIL  ") << test.name << "\n";
+        ++run;
+    }
+    if (!directory.empty()) {
+        std::error_code ignored;
+        std::filesystem::remove_all(directory, ignored);
+    }
+    std::cout << run << " tests, " << failures << " failed checks\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// Plans of every solver mode, whole and in chunks: valid for plenty of stock
+// and for too little, the same again for the same seed, and with offcuts
+// booked out of the store they were cut from.
+
+#include "chunked_solver.h"
+#include "remnant_store.h"
+#include "test.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+const SolverMode allModes[] = {SolverMode::Greedy, SolverMode::BestFit, SolverMode::ColumnGeneration,
+                               SolverMode::LocalSearch};
+
+SolverOptions optionsFor(SolverMode mode) {
+    SolverOptions options;
+    options.mode = mode;
+    options.threads = 2;
+    options.searchStarts = 2;
+    options.searchMoves = 2000;
+    return options;
+}
+
+int missingPieces(const CuttingResult &result) {
+    int missing = 0;
+    for (const Shortage &shortage : result.shortages)
+        missing += shortage.quantity;
+    return missing;
+}
+
+} // namespace
+
+TEST(plansAreValidInEveryMode) {
+    for (std::uint64_t seed = 1; seed <= 4; ++seed) {
+        for (double stockShare : {0.7, 1.05, 2.0}) {
+            const CuttingJob job = randomJob(seed, 3, 15, stockShare);
+            for (SolverMode mode : allModes) {
+                const CuttingResult result = solveCuttingJob(job, optionsFor(mode));
+                const std::string problem = planProblem(job, result);
+                if (!problem.empty())
+                    reportFailure(__FILE__, __LINE__, std::string(solverModeName(mode)) + ": " + problem);
+                CHECK(result.cutStockLength() + 1e-6 >= result.stockLowerBound || !result.shortages.empty());
+                CHECK(stockShare < 1.5 || result.shortages.empty());
+            }
+        }
+    }
+}
+
+TEST(profileWithoutStockIsReported) {
+    CuttingJob job;
+    job.stock.push_back({"A", 2, 6000.0, 0.0});
+    job.cuts.push_back({"A", 2500.0, 4});
+    job.cuts.push_back({"B", 1000.0, 3});
+    for (SolverMode mode : allModes) {
+        const CuttingResult result = solveCuttingJob(job, optionsFor(mode));
+        CHECK(planProblem(job, result).empty());
+        bool reported = false;
+        for (const Shortage &shortage : result.shortages)
+            reported = reported || (shortage.profileName == "B" && shortage.noStock);
+        CHECK(reported);
+    }
+}
+
+TEST(localSearchRepeatsForTheSameSeed) {
+    const CuttingJob job = randomJob(7, 2, 25, 1.1);
+    SolverOptions options = optionsFor(SolverMode::LocalSearch);
+    options.searchStarts = 3;
+    std::string plans[3];
+    const unsigned threads[] = {1, 2, 4};
+    for (int i = 0; i < 3; ++i) {
+        options.threads = threads[i];
+        plans[i] = formatCuttingResult(solveCuttingJob(job, options));
+    }
+    CHECK(plans[0] == plans[1]);
+    CHECK(plans[0] == plans[2]);
+
+    options.seed = 2;
+    CHECK(planProblem(job, solveCuttingJob(job, options)).empty());
+}
+
+TEST(chunkedPlansAreValid) {
+    const CuttingJob job = randomJob(8, 3, 30, 1.05);
+    const std::string fileName = temporaryFile("chunked.txt");
+    REQUIRE(saveJobFile(fileName, job));
+    for (SolverMode mode : allModes) {
+        for (long long chunkPieces : {50LL, 400LL}) {
+            JobReader reader;
+            REQUIRE(reader.open(fileName));
+            ChunkOptions chunking;
+            chunking.chunkPieces = chunkPieces;
+            const CuttingResult result = solveJobInChunks(reader, optionsFor(mode), chunking);
+            const std::string problem = planProblem(job, result);
+            if (!problem.empty())
+                reportFailure(__FILE__, __LINE__, std::string(solverModeName(mode)) + ": " + problem);
+        }
+    }
+}
+
+TEST(offcutsAreBookedOutOfTheStore) {
+    // Four offcuts of A, two of them the same length
+    const std::string fileName = temporaryFile(std::string("booked") + remnantStoreExtension);
+    CuttingResult earlier;
+    earlier.schemes.push_back({"A", 6000.0, {3000.0}, 3000.0, 2, false, {}});
+    earlier.schemes.push_back({"A", 6000.0, {4000.0}, 2000.0, 1, false, {}});
+    earlier.schemes.push_back({"A", 6000.0, {5200.0}, 800.0, 1, false, {}});
+    REQUIRE(RemnantStore::update(fileName, earlier, 500.0));
+
+    CuttingJob job;
+    job.stock.push_back({"A", 5, 6000.0, 0.0});
+    job.cuts.push_back({"A", 2900.0, 1});
+    job.cuts.push_back({"A", 1900.0, 1});
+    job.cuts.push_back({"A", 5000.0, 2});
+    RemnantStore store;
+    REQUIRE(store.open(fileName));
+    SolverOptions options = optionsFor(SolverMode::Greedy);
+    options.remnants = &store;
+    CuttingResult result = solveCuttingJob(job, options);
+    store.identifyOffcuts(result);
+    CHECK(planProblem(job, result).empty());
+    CHECK(missingPieces(result) == 0);
+
+    int offcutsCut = 0;
+    for (const CuttingScheme &scheme : result.schemes) {
+        if (!scheme.fromRemnant)
+            continue;
+        CHECK(scheme.offcuts.size() == static_cast<std::size_t>(scheme.count));
+        for (std::size_t position : scheme.offcuts) {
+            REQUIRE(position < store.size());
+            CHECK(store.begin("A")[position] == scheme.stockLength);
+        }
+        offcutsCut += scheme.count;
+    }
+    CHECK(offcutsCut == 2);
+    store.close();
+
+    // The two cut are gone, the rest stay, and the new remainders are added
+    std::string errorMessage;
+    REQUIRE(RemnantStore::update(fileName, result, 500.0, &errorMessage));
+    REQUIRE(store.open(fileName));
+    std::vector<double> expected = {800.0, 3000.0};
+    for (const CuttingScheme &scheme : result.schemes) {
+        if (scheme.remainder >= 500.0)
+            expected.insert(expected.end(), scheme.count, scheme.remainder);
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK(std::vector<double>(store.begin("A"), store.end("A")) == expected);
+    store.close();
+
+    // A plan made against the store before it changed is refused
+    CHECK(!RemnantStore::update(fileName, result, 500.0, &errorMessage));
+}
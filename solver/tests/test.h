@@ -0,0 +1,52 @@
+#ifndef SOLVER_TEST_H
+#define SOLVER_TEST_H
+
+// A minimal test harness, so the solver tests need nothing the solver does
+// not: TEST defines and registers a test, CHECK records a failure and carries
+// on, REQUIRE ends the test at the first one.
+
+#include "cutting_job.h"
+#include "cutting_solver.h"
+
+#include <cstdint>
+#include <string>
+
+void registerTest(const char *name, void (*run)());
+void reportFailure(const char *file, int line, const std::string &message);
+
+struct TestRegistration {
+    TestRegistration(const char *name, void (*run)()) { registerTest(name, run); }
+};
+
+#define TEST(name)                                                      \
+    static void name();                                                 \
+    static const TestRegistration name##Registration(#name, &name);     \
+    static void name()
+
+#define CHECK(condition)                                                \
+    do {                                                                \
+        if (!(condition))                                               \
+            reportFailure(__FILE__, __LINE__, #condition);              \
+    } while (false)
+
+#define REQUIRE(condition)                                              \
+    do {                                                                \
+        if (!(condition)) {                                             \
+            reportFailure(__FILE__, __LINE__, #condition);              \
+            return;                                                     \
+        }                                                               \
+    } while (false)
+
+// A file name in a directory of its own that is removed when the tests end
+std::string temporaryFile(const std::string &name);
+
+// A job with `profiles` profiles of random pieces, some stock rows priced.
+// `stockShare` is the stock length over the piece length; below 1 some
+// pieces cannot be cut.
+CuttingJob randomJob(std::uint64_t seed, int profiles, int lengths, double stockShare);
+
+// Every scheme fits its bar, no more bars are cut than there are, and every
+// piece is either cut or reported short. Returns an empty string or what is wrong.
+std::string planProblem(const CuttingJob &job, const CuttingResult &result);
+
+#endif // SOLVER_TEST_H
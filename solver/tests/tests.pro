@@ -0,0 +1,21 @@
+# Solver tests: `solver_tests` runs them all, `solver_tests <name>` those whose
+# names contain it.
+
+TEMPLATE = app
+TARGET = solver_tests
+CONFIG += console c++17 testcase
+CONFIG -= qt app_bundle
+
+include(../solver.pri)
+
+SOURCES += \
+    file_format_tests.cpp \
+    kernel_tests.cpp \
+    length_tests.cpp \
+    main.cpp \
+    plan_tests.cpp
+
+HEADERS += \
+    test.h
+
+unix: LIBS += -pthread
@@ -0,0 +1,16 @@
+#ifndef TEXT_ESCAPE_H
+#define TEXT_ESCAPE_H
+
+// Quoting of names in the JSON and CSV that the solver and its tools write, so
+// that every file escapes them the same way.
+
+#include <string>
+
+// A JSON string literal; control characters become \u00XX
+std::string jsonString(const std::string &text);
+
+// A field of a CSV line split by `separator`, quoted only when it has to be,
+// doubling the quotes inside
+std::string csvField(const std::string &text, char separator = ',');
+
+#endif // TEXT_ESCAPE_H